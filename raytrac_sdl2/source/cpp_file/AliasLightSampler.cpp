@@ -0,0 +1,64 @@
+#include "AliasLightSampler.h"
+#include <algorithm>
+
+void AliasLightSampler::build(const std::vector<std::shared_ptr<Light>>& lights, float scene_radius) {
+    const size_t n = lights.size();
+    bins.assign(n, Bin{ 1.0f, 0 });
+    pdfs.assign(n, 0.0f);
+    if (n == 0)
+        return;
+
+    double total = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        pdfs[i] = std::max(LightSampler::power(*lights[i], scene_radius), 0.0f);
+        total += pdfs[i];
+    }
+    // Nothing emits measurable power: fall back to uniform selection
+    for (size_t i = 0; i < n; ++i)
+        pdfs[i] = total > 0.0 ? static_cast<float>(pdfs[i] / total) : 1.0f / n;
+
+    // Vose: split scaled probabilities into under- and overfull bins and pair them up
+    std::vector<double> scaled(n);
+    std::vector<int> small, large;
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = pdfs[i] * n;
+        bins[i].alias = static_cast<int>(i);
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<int>(i));
+    }
+    while (!small.empty() && !large.empty()) {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+        bins[s].probability = static_cast<float>(scaled[s]);
+        bins[s].alias = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Leftovers are full bins up to rounding error
+    for (int i : large)
+        bins[i].probability = 1.0f;
+    for (int i : small)
+        bins[i].probability = 1.0f;
+}
+
+int AliasLightSampler::sample(float u, const Vec3SIMD& point, float& pdf) const {
+    if (bins.empty()) {
+        pdf = 0.0f;
+        return -1;
+    }
+    const float scaled = u * bins.size();
+    const int bin = std::min(static_cast<int>(scaled), static_cast<int>(bins.size()) - 1);
+    const float remainder = scaled - bin;
+    const int index = remainder < bins[bin].probability ? bin : bins[bin].alias;
+    pdf = pdfs[index];
+    return index;
+}
+
+float AliasLightSampler::pdf(int light_index, const Vec3SIMD& point) const {
+    if (light_index < 0 || light_index >= static_cast<int>(pdfs.size()))
+        return 0.0f;
+    return pdfs[light_index];
+}
@@ -0,0 +1,38 @@
+#include "AlphaMask.h"
+#include "Texture.h"
+
+std::shared_ptr<AlphaMask> AlphaMask::build(const Texture& texture, bool alpha_only, float intensity,
+    const UVTransform* transform, float cutoff) {
+    const int width = texture.get_width();
+    const int height = texture.get_height();
+    if (width <= 0 || height <= 0)
+        return nullptr;
+
+    auto mask = std::make_shared<AlphaMask>();
+    mask->width = width;
+    mask->height = height;
+    const size_t count = static_cast<size_t>(width) * height;
+    mask->bits.assign((count + 63) / 64, 0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float opacity = texture.texel_alpha(x, y);
+            if (!alpha_only) {
+                const Vec3 color = texture.texel(x, y);
+                opacity *= static_cast<float>(color.x + color.y + color.z) / 3.0f;
+            }
+            if (opacity * intensity >= cutoff) {
+                const size_t index = static_cast<size_t>(y) * width + x;
+                mask->bits[index >> 6] |= uint64_t(1) << (index & 63);
+                ++mask->solid_count;
+            }
+        }
+    }
+    if (mask->solid_count == count)
+        return nullptr;
+
+    if (transform) {
+        mask->transform = *transform;
+        mask->transformed = true;
+    }
+    return mask;
+}
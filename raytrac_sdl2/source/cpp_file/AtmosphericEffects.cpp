@@ -8,7 +8,71 @@ AtmosphericEffects::AtmosphericEffects(
     : fog_start_distance(fog_start), fog_base_density(fog_base),
     fog_distance_factor(fog_factor), haze_density(haze),
     fog_color(fog_col), haze_color(haze_col),
-    background_color(bg_col), use_background_texture(false) {}
+    background_color(bg_col), use_background_texture(false) {
+    compile();
+}
+
+void AtmosphericEffects::compile() {
+    fog_segment_color = fog_texture.has_value() ? Vec3SIMD(fog_texture->get_color(0.5f, 0.5f)) : Vec3SIMD(fog_color);
+    haze_segment_color = haze_texture.has_value() ? Vec3SIMD(haze_texture->get_color(0.5f, 0.5f)) : Vec3SIMD(haze_color);
+    has_medium = fog_base_density > 0.0f || fog_distance_factor > 0.0f || haze_density > 0.0f;
+    fog_lut.clear();
+    haze_lut.clear();
+    transmittance_lut.clear();
+    if (!has_medium)
+        return;
+
+    // Tablo iki faktr de 1'e doyana kadar uzanr; tesi analitik hesaplanr
+    float range = 1.0f;
+    if (fog_distance_factor > 0.0f)
+        range = std::max(range, fog_start_distance + std::max(0.0f, 1.0f - fog_base_density) / fog_distance_factor);
+    if (haze_density > 0.0f)
+        range = std::max(range, 1.0f / haze_density);
+    lut_range = std::min(range, 1e5f);
+    lut_inv_step = (lut_size - 1) / lut_range;
+
+    fog_lut.resize(lut_size);
+    haze_lut.resize(lut_size);
+    transmittance_lut.resize(lut_size);
+    for (int i = 0; i < lut_size; ++i) {
+        float d = i / lut_inv_step;
+        // Sis balangtaki srama fogAt'te uygulanr; tablo srekli kalr
+        float fog_depth = std::max(0.0f, d - fog_start_distance);
+        fog_lut[i] = std::min(1.0f, fog_base_density + fog_depth * fog_distance_factor);
+        haze_lut[i] = calculateHazeFactor(d);
+        transmittance_lut[i] = std::exp(-(d * haze_density + fog_depth * fog_distance_factor));
+    }
+}
+
+float AtmosphericEffects::lookup(const std::vector<float>& table, float distance) const {
+    float x = std::max(distance, 0.0f) * lut_inv_step;
+    int i = static_cast<int>(x);
+    if (i >= lut_size - 1)
+        return table.back();
+    float f = x - i;
+    return table[i] + (table[i + 1] - table[i]) * f;
+}
+
+float AtmosphericEffects::fogAt(float distance) const {
+    if (!has_medium || distance <= fog_start_distance)
+        return 0.0f;
+    return distance < lut_range ? lookup(fog_lut, distance) : calculateFogFactor(distance);
+}
+
+float AtmosphericEffects::hazeAt(float distance) const {
+    if (!has_medium)
+        return 0.0f;
+    return distance < lut_range ? lookup(haze_lut, distance) : calculateHazeFactor(distance);
+}
+
+float AtmosphericEffects::lightTransmittance(float distance) const {
+    if (!has_medium)
+        return 1.0f;
+    if (distance < lut_range)
+        return lookup(transmittance_lut, distance);
+    float fog_depth = std::max(0.0f, distance - fog_start_distance);
+    return std::exp(-(distance * haze_density + fog_depth * fog_distance_factor));
+}
 
 void AtmosphericEffects::setFogTexture(const std::string& texture_path) {
     if (!texture_path.empty()) {
@@ -17,6 +81,7 @@ void AtmosphericEffects::setFogTexture(const std::string& texture_path) {
     else {
         fog_texture.reset();
     }
+    compile();
 }
 
 void AtmosphericEffects::setHazeTexture(const std::string& texture_path) {
@@ -26,6 +91,7 @@ void AtmosphericEffects::setHazeTexture(const std::string& texture_path) {
     else {
         haze_texture.reset();
     }
+    compile();
 }
 
 void AtmosphericEffects::setBackgroundTexture(const std::string& texture_path) {
@@ -56,26 +122,32 @@ Vec3SIMD AtmosphericEffects::getBackgroundColor(float u, float v) const {
 
 void AtmosphericEffects::setFogStartDistance(float distance) {
     fog_start_distance = distance;
+    compile();
 }
 
 void AtmosphericEffects::setFogBaseDensity(float density) {
     fog_base_density = density;
+    compile();
 }
 
 void AtmosphericEffects::setFogDistanceFactor(float factor) {
     fog_distance_factor = factor;
+    compile();
 }
 
 void AtmosphericEffects::setHazeDensity(float density) {
     haze_density = density;
+    compile();
 }
 
 void AtmosphericEffects::setFogColor(const Vec3SIMD& color) {
     fog_color = color;
+    compile();
 }
 
 void AtmosphericEffects::setHazeColor(const Vec3SIMD& color) {
     haze_color = color;
+    compile();
 }
 
 float AtmosphericEffects::getFogStartDistance() const {
@@ -112,45 +184,29 @@ float AtmosphericEffects::calculateHazeFactor(float distance) const {
     return std::min(1.0f, distance * haze_density);
 }
 Vec3SIMD AtmosphericEffects::attenuateSegment(const Vec3SIMD& color, float start_distance, float end_distance) const {
-    if (!enable) return color;
-
-    float start_fog_factor = calculateFogFactor(start_distance);
-    float end_fog_factor = calculateFogFactor(end_distance);
-    float start_haze_factor = calculateHazeFactor(start_distance);
-    float end_haze_factor = calculateHazeFactor(end_distance);
+    if (!active()) return color;
 
-    float avg_fog_factor = (start_fog_factor + end_fog_factor) * 0.5f;
-    float avg_haze_factor = (start_haze_factor + end_haze_factor) * 0.5f;
-
-    Vec3 fog_contribution = fog_texture.has_value() ? fog_texture->get_color(0.5f, 0.5f) : Vec3(fog_color);
-    Vec3 haze_contribution = haze_texture.has_value() ? haze_texture->get_color(0.5f, 0.5f) : Vec3(haze_color);
+    float avg_fog_factor = (fogAt(start_distance) + fogAt(end_distance)) * 0.5f;
+    float avg_haze_factor = (hazeAt(start_distance) + hazeAt(end_distance)) * 0.5f;
 
     return color * (1.0f - avg_fog_factor) * (1.0f - avg_haze_factor) +
-        fog_contribution * avg_fog_factor +
-        haze_contribution * avg_haze_factor;
+        fog_segment_color * avg_fog_factor +
+        haze_segment_color * avg_haze_factor;
 }
 
 Vec3SIMD AtmosphericEffects::calculateSegmentContribution(float start_distance, float end_distance) const {
-    if (!enable) return Vec3SIMD(0.0f, 0.0f, 0.0f);
-
-    float start_fog_factor = calculateFogFactor(start_distance);
-    float end_fog_factor = calculateFogFactor(end_distance);
-    float start_haze_factor = calculateHazeFactor(start_distance);
-    float end_haze_factor = calculateHazeFactor(end_distance);
-
-    float fog_contribution = end_fog_factor - start_fog_factor;
-    float haze_contribution = end_haze_factor - start_haze_factor;
+    if (!active()) return Vec3SIMD(0.0f, 0.0f, 0.0f);
 
-    Vec3SIMD fog_color_contribution = fog_texture.has_value() ? fog_texture->get_color(0.5f, 0.5f) : Vec3(fog_color);
-    Vec3SIMD haze_color_contribution = haze_texture.has_value() ? haze_texture->get_color(0.5f, 0.5f) : Vec3(haze_color);
+    float fog_contribution = fogAt(end_distance) - fogAt(start_distance);
+    float haze_contribution = hazeAt(end_distance) - hazeAt(start_distance);
 
-    return fog_color_contribution * fog_contribution + haze_color_contribution * haze_contribution;
+    return fog_segment_color * fog_contribution + haze_segment_color * haze_contribution;
 }
 Vec3SIMD AtmosphericEffects::applyAtmosphericEffects(const Vec3SIMD& color, float distance, float u, float v) const {
-    if (!enable) return color;
+    if (!active()) return color;
 
-    float fog_factor = calculateFogFactor(distance);
-    float haze_factor = calculateHazeFactor(distance);
+    float fog_factor = fogAt(distance);
+    float haze_factor = hazeAt(distance);
 
     Vec3 fog_contribution = fog_texture.has_value() ? fog_texture->get_color(u, v) : fog_color;
     Vec3 haze_contribution = haze_texture.has_value() ? haze_texture->get_color(u, v) : haze_color;
@@ -0,0 +1,512 @@
+#include "Benchmark.h"
+#include "Renderer.h"
+#include "SpotLight.h"
+#include "MaterialDispatch.h"
+#include "WavefrontIntegrator.h"
+#include <chrono>
+#include <random>
+
+namespace {
+    using bench_clock = std::chrono::steady_clock;
+
+    double ns_per(bench_clock::time_point start, size_t count) {
+        return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count() / std::max<size_t>(count, 1);
+    }
+
+    // Mixed point / spot / area lights above a 40 x 40 ground, plus one sun.
+    std::vector<std::shared_ptr<Light>> random_lights(int count, std::mt19937& gen) {
+        std::uniform_real_distribution<float> u(0.0f, 1.0f);
+        std::vector<std::shared_ptr<Light>> lights;
+        lights.push_back(std::make_shared<DirectionalLight>(Vec3SIMD(0.3f, -1.0f, 0.2f), Vec3SIMD(1, 1, 1), 1.0));
+        for (int i = 1; i < count; ++i) {
+            Vec3SIMD p(u(gen) * 40.0f - 20.0f, 1.0f + u(gen) * 6.0f, u(gen) * 40.0f - 20.0f);
+            Vec3SIMD color(u(gen), u(gen), u(gen));
+            switch (i % 3) {
+            case 0:
+                lights.push_back(std::make_shared<PointLight>(p, color, 0.0f));
+                break;
+            case 1:
+                lights.push_back(std::make_shared<SpotLight>(p, Vec3SIMD(u(gen) - 0.5f, -1.0f, u(gen) - 0.5f), color, 35.0f, 0.0f));
+                break;
+            default:
+                lights.push_back(std::make_shared<AreaLight>(p, Vec3SIMD(1, 0, 0), Vec3SIMD(0, 0, 1), 0.5, 0.5, color));
+                break;
+            }
+        }
+        return lights;
+    }
+
+    // The dispatch the integrator used before the light table: a cast chain per light.
+    Vec3SIMD incident_rtti(const std::shared_ptr<Light>& light, const Vec3SIMD& point) {
+        if (auto directional = std::dynamic_pointer_cast<DirectionalLight>(light)) {
+            return directional->intensity;
+        }
+        else if (auto point_light = std::dynamic_pointer_cast<PointLight>(light)) {
+            float d = (point_light->getPosition() - point).length();
+            return point_light->getIntensity() / (d * d);
+        }
+        else if (auto spot = std::dynamic_pointer_cast<SpotLight>(light)) {
+            Vec3SIMD to_light = spot->position - point;
+            float d = to_light.length();
+            float cos_theta = -(to_light / d).dot(spot->direction);
+            if (cos_theta <= std::cos(spot->angle_degrees * static_cast<float>(M_PI / 180.0)))
+                return Vec3SIMD(0, 0, 0);
+            return spot->intensity * (cos_theta * cos_theta) / (d * d);
+        }
+        else if (auto area = std::dynamic_pointer_cast<AreaLight>(light)) {
+            float d = (area->random_point() - point).length();
+            return area->getIntensity() / (d * d);
+        }
+        return Vec3SIMD(0, 0, 0);
+    }
+
+    // 40 x 40 ground quad with boxes standing on it so shadow rays do real work.
+    // Box tops are quads at height 2 * half_height.
+    // With several materials the ground takes the first and the boxes cycle through all.
+    HittableList occluder_scene(int boxes, float half_height, std::mt19937& gen, const std::vector<std::shared_ptr<Material>>& materials) {
+        std::uniform_real_distribution<float> u(0.0f, 1.0f);
+        HittableList world;
+        world.add(std::make_shared<Triangle>(Vec3SIMD(-20, 0, -20), Vec3SIMD(20, 0, -20), Vec3SIMD(20, 0, 20), materials[0]));
+        world.add(std::make_shared<Triangle>(Vec3SIMD(-20, 0, -20), Vec3SIMD(20, 0, 20), Vec3SIMD(-20, 0, 20), materials[0]));
+        for (int b = 0; b < boxes; ++b) {
+            const std::shared_ptr<Material>& material = materials[b % materials.size()];
+            float h = 2.0f * half_height * (0.25f + 0.75f * u(gen));
+            Vec3SIMD c(u(gen) * 36.0f - 18.0f, h, u(gen) * 36.0f - 18.0f);
+            Vec3SIMD a = c + Vec3SIMD(-0.5f, 0.0f, -0.5f), bb = c + Vec3SIMD(0.5f, 0.0f, -0.5f);
+            Vec3SIMD cc = c + Vec3SIMD(0.5f, 0.0f, 0.5f), d = c + Vec3SIMD(-0.5f, 0.0f, 0.5f);
+            world.add(std::make_shared<Triangle>(a, bb, cc, material));
+            world.add(std::make_shared<Triangle>(a, cc, d, material));
+        }
+        return world;
+    }
+
+    HittableList occluder_scene(int boxes, float half_height, std::mt19937& gen, const std::shared_ptr<Material>& material) {
+        return occluder_scene(boxes, half_height, gen, std::vector<std::shared_ptr<Material>>{ material });
+    }
+
+    float luminance(const Vec3SIMD& c) {
+        return 0.2126f * c.x() + 0.7152f * c.y() + 0.0722f * c.z();
+    }
+}
+
+int Benchmark::run(const RenderSettings& settings) {
+    if (settings.benchmark == "direct-lighting")
+        return direct_lighting(settings);
+    if (settings.benchmark == "sun-cache")
+        return sun_cache(settings);
+    if (settings.benchmark == "scatter")
+        return scatter(settings);
+    if (settings.benchmark == "wavefront")
+        return wavefront(settings);
+    if (settings.benchmark == "roulette")
+        return roulette(settings);
+    std::cerr << "Unknown benchmark: " << settings.benchmark << " (available: direct-lighting, sun-cache, scatter, wavefront, roulette)" << std::endl;
+    return 1;
+}
+
+int Benchmark::direct_lighting(const RenderSettings& settings) {
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+
+    auto material = std::make_shared<PrincipledBSDF>(Vec3(0.7, 0.7, 0.7), 0.5f, 0.0f);
+    HittableList world = occluder_scene(64, 0.5f, gen, material);
+    auto bvh = std::make_shared<ParallelBVHNode>(world.objects, 0, world.objects.size(), 0.0, 1.0);
+
+    const int points = 4096;
+    std::vector<HitRecord> records(points);
+    for (HitRecord& rec : records) {
+        rec.point = Vec3SIMD(u(gen) * 38.0f - 19.0f, 0.001f, u(gen) * 38.0f - 19.0f);
+        rec.normal = Vec3(0, 1, 0);
+        rec.material_id = scene_materials.add(material);
+    }
+    scene_materials.compile();
+
+    Renderer renderer(settings.width, settings.height, MAX_DEPTH, 1);
+    std::cout << "direct-lighting: " << points << " shading points, " << world.size() << " occluder triangles" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (int count : { 1, 16, 256, 4096 }) {
+        auto lights = random_lights(count, gen);
+        renderer.build_light_sampling(lights, 30.0f);
+        const int rounds = 64;
+
+        // Full estimate: light selection, sampling, one shadow ray
+        Vec3SIMD sink(0, 0, 0);
+        auto start = bench_clock::now();
+        for (int r = 0; r < rounds; ++r)
+            for (const HitRecord& rec : records)
+                sink += renderer.calculate_direct_lighting(bvh.get(), lights, rec, rec.normal);
+        double estimate_ns = ns_per(start, size_t(rounds) * points);
+
+        // Per-light dispatch only, all lights per point
+        const int dispatch_points = std::max(1, points * 16 / count);
+        start = bench_clock::now();
+        for (int p = 0; p < dispatch_points; ++p)
+            for (const auto& light : lights)
+                sink += incident_rtti(light, records[p % points].point);
+        double rtti_ns = ns_per(start, size_t(dispatch_points) * lights.size());
+
+        const LightTable& table = renderer.light_table;
+        start = bench_clock::now();
+        for (int p = 0; p < dispatch_points; ++p) {
+            const Vec3SIMD& point = records[p % points].point;
+            for (int i = 0; i < static_cast<int>(table.size()); ++i) {
+                Vec3SIMD to_light;
+                float distance;
+                if (table.sample_direction(i, point, 0.5f, 0.5f, to_light, distance))
+                    sink += table.incident(i, point, to_light, distance);
+            }
+        }
+        double table_ns = ns_per(start, size_t(dispatch_points) * table.size());
+
+        std::cout << "  lights " << std::setw(5) << count
+            << "  estimate " << std::setw(8) << estimate_ns << " ns/point"
+            << "  dispatch rtti " << std::setw(6) << rtti_ns << " ns/light"
+            << "  table " << std::setw(6) << table_ns << " ns/light"
+            << "  (" << (lights.size() >= light_tree_min_lights ? "light tree" : "alias table") << ")"
+            << "  checksum " << sink.max_component() << std::endl;
+    }
+    return 0;
+}
+
+int Benchmark::sun_cache(const RenderSettings& settings) {
+    std::mt19937 gen(4321);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+
+    auto material = std::make_shared<PrincipledBSDF>(Vec3(0.7, 0.7, 0.7), 0.5f, 0.0f);
+    HittableList world = occluder_scene(2048, 1.5f, gen, material);
+    auto bvh = std::make_shared<ParallelBVHNode>(world.objects, 0, world.objects.size(), 0.0, 1.0);
+
+    std::vector<std::shared_ptr<Light>> lights;
+    lights.push_back(std::make_shared<DirectionalLight>(Vec3SIMD(0.3f, -1.0f, 0.2f), Vec3SIMD(1, 1, 1), 8.0));
+    LightTable table;
+    table.build(lights);
+
+    SunVisibilityCache cache;
+    auto start = bench_clock::now();
+    if (!cache.build(world.objects, table)) {
+        std::cerr << "sun-cache: cache build failed" << std::endl;
+        return 1;
+    }
+    double build_ms = std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+
+    // Shading points on the ground and on box tops, one jittered sun sample each
+    const int points = 1 << 18;
+    std::vector<Vec3SIMD> origins(points), directions(points);
+    for (int i = 0; i < points; ++i) {
+        Vec3SIMD p(u(gen) * 38.0f - 19.0f, 0.0f, u(gen) * 38.0f - 19.0f);
+        if (i % 4 == 0) {
+            // Straight down onto whatever is below, as a camera ray would land
+            HitRecord rec;
+            if (bvh->hit(Ray(p + Vec3SIMD(0, 10, 0), Vec3SIMD(0, -1, 0)), 0.001, 20.0, rec))
+                p = rec.point;
+        }
+        origins[i] = p;
+        float distance;
+        table.sample_direction(cache.light(), p, u(gen), u(gen), directions[i], distance);
+    }
+
+    std::vector<char> reference(points);
+    start = bench_clock::now();
+    for (int i = 0; i < points; ++i) {
+        HitRecord rec;
+        reference[i] = bvh->hit(Ray(origins[i], directions[i]), 0.01f, std::numeric_limits<double>::infinity(), rec);
+    }
+    double bvh_ns = ns_per(start, points);
+
+    std::vector<char> cached(points);
+    start = bench_clock::now();
+    for (int i = 0; i < points; ++i)
+        cached[i] = cache.occluded(origins[i], directions[i], 0.01f, bvh.get());
+    double cache_ns = ns_per(start, points);
+
+    size_t mismatches = 0, shadowed = 0, counts[3] = { 0, 0, 0 };
+    for (int i = 0; i < points; ++i) {
+        SunVisibilityCache::Resolution resolved;
+        cache.occluded(origins[i], directions[i], 0.01f, bvh.get(), &resolved);
+        ++counts[static_cast<int>(resolved)];
+        mismatches += reference[i] != cached[i];
+        shadowed += reference[i];
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "sun-cache: " << points << " shadow rays, " << world.size() << " triangles, "
+        << cache.entry_count() << " grid entries built in " << build_ms << " ms" << std::endl;
+    std::cout << "  bvh " << std::setw(7) << bvh_ns << " ns/ray  cache " << std::setw(7) << cache_ns << " ns/ray"
+        << "  shadowed " << 100.0 * shadowed / points << "%" << std::endl;
+    std::cout << "  resolved: lit " << 100.0 * counts[0] / points << "%, tested " << 100.0 * counts[1] / points
+        << "%, bvh fallback " << 100.0 * counts[2] / points << "%" << std::endl;
+    std::cout << "  mismatches " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+int Benchmark::scatter(const RenderSettings&) {
+    std::mt19937 gen(2468);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+
+    // Mixed material set: rough plastic, glossy metal, clearcoat, Metal
+    std::vector<std::shared_ptr<Material>> materials;
+    materials.push_back(std::make_shared<PrincipledBSDF>(Vec3(0.7, 0.6, 0.5), 0.8f, 0.0f));
+    materials.push_back(std::make_shared<PrincipledBSDF>(Vec3(0.9, 0.8, 0.6), 0.2f, 1.0f));
+    auto coated = std::make_shared<PrincipledBSDF>(Vec3(0.2, 0.3, 0.8), 0.5f, 0.0f);
+    coated->setClearcoat(1.0f, 0.05f);
+    materials.push_back(coated);
+    materials.push_back(std::make_shared<Metal>(Vec3(0.8, 0.8, 0.8), 0.3f, 1.0f, 0.0f, 0.0f));
+
+    // Random shading points; wo and the light direction come from the upper hemisphere
+    const int vertices = 1 << 16;
+    std::vector<HitRecord> records(vertices);
+    std::vector<Ray> incoming(vertices);
+    std::vector<Vec3SIMD> to_light(vertices);
+    for (int i = 0; i < vertices; ++i) {
+        HitRecord& rec = records[i];
+        Vec3SIMD n = MicrofacetLobes::sample_cosine(u(gen), u(gen), Vec3SIMD(0, 1, 0));
+        rec.point = Vec3SIMD(u(gen), u(gen), u(gen));
+        rec.normal = n;
+        rec.front_face = true;
+        rec.uv = Vec2(u(gen), u(gen));
+        rec.u = rec.uv.u;
+        rec.v = rec.uv.v;
+        rec.material_id = scene_materials.add(materials[i % materials.size()]);
+        Vec3SIMD wo = MicrofacetLobes::sample_cosine(u(gen), u(gen), n);
+        incoming[i] = Ray(rec.point + wo, -wo);
+        to_light[i] = MicrofacetLobes::sample_cosine(u(gen), u(gen), n);
+    }
+
+    std::cout << "scatter: " << vertices << " path vertices over " << materials.size() << " materials" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    const int rounds = 16;
+
+    // Before: scatter() then pdf() for the continuation, eval() and pdf()
+    // again for the light sample, each rebuilding the lobes
+    Vec3SIMD sink(0, 0, 0);
+    auto start = bench_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < vertices; ++i) {
+            const HitRecord& rec = records[i];
+            Vec3SIMD wo = -incoming[i].direction;
+            Vec3SIMD attenuation;
+            Ray scattered;
+            if (rec.material()->scatter(incoming[i], rec, attenuation, scattered))
+                sink += attenuation * rec.material()->pdf(rec, wo, scattered.direction);
+            Vec3SIMD f = rec.material()->eval(rec, wo, to_light[i]);
+            sink += f * rec.material()->pdf(rec, wo, to_light[i]);
+        }
+    }
+    double before_ns = ns_per(start, size_t(rounds) * vertices);
+    float before_sum = sink.x() + sink.y() + sink.z();
+
+    // After: sample() returns the weight and pdf together, eval() fills the pdf
+    sink = Vec3SIMD(0, 0, 0);
+    start = bench_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < vertices; ++i) {
+            const HitRecord& rec = records[i];
+            Vec3SIMD wo = -incoming[i].direction;
+            Vec3SIMD attenuation;
+            Ray scattered;
+            float pdf;
+            if (rec.material()->sample(incoming[i], rec, attenuation, scattered, pdf))
+                sink += attenuation * pdf;
+            Vec3SIMD f = rec.material()->eval(rec, wo, to_light[i], pdf);
+            sink += f * pdf;
+        }
+    }
+    double after_ns = ns_per(start, size_t(rounds) * vertices);
+    float after_sum = sink.x() + sink.y() + sink.z();
+
+    // The same pair through the compiled records and the type switch
+    scene_materials.compile();
+    sink = Vec3SIMD(0, 0, 0);
+    start = bench_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < vertices; ++i) {
+            const HitRecord& rec = records[i];
+            const CompiledMaterial& material = scene_materials.compiled(rec.material_id);
+            Vec3SIMD wo = -incoming[i].direction;
+            Vec3SIMD attenuation;
+            Ray scattered;
+            float pdf;
+            if (MaterialDispatch::sample(material, incoming[i], rec, attenuation, scattered, pdf))
+                sink += attenuation * pdf;
+            Vec3SIMD f = MaterialDispatch::eval(material, rec, wo, to_light[i], pdf);
+            sink += f * pdf;
+        }
+    }
+    double switch_ns = ns_per(start, size_t(rounds) * vertices);
+    float switch_sum = sink.x() + sink.y() + sink.z();
+
+    // The light-sample half is deterministic, so both paths must agree on it
+    size_t mismatches = 0;
+    for (int i = 0; i < vertices; ++i) {
+        const HitRecord& rec = records[i];
+        Vec3SIMD wo = -incoming[i].direction;
+        float pdf;
+        Vec3SIMD combined = rec.material()->eval(rec, wo, to_light[i], pdf);
+        Vec3SIMD separate = rec.material()->eval(rec, wo, to_light[i]);
+        float separate_pdf = rec.material()->pdf(rec, wo, to_light[i]);
+        float tolerance = 1e-4f * (1.0f + separate.max_component() + separate_pdf);
+        if ((combined - separate).length() > tolerance || std::abs(pdf - separate_pdf) > tolerance)
+            ++mismatches;
+    }
+
+    std::cout << "  before " << std::setw(7) << before_ns << " ns/vertex  after " << std::setw(7) << after_ns
+        << " ns/vertex  (" << std::setprecision(2) << before_ns / std::max(after_ns, 1e-3) << "x)"
+        << std::setprecision(1) << "  switch " << std::setw(7) << switch_ns << " ns/vertex" << std::endl;
+    std::cout << "  checksum " << before_sum << " / " << after_sum << " / " << switch_sum
+        << "  eval/pdf mismatches " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+int Benchmark::wavefront(const RenderSettings& settings) {
+    std::mt19937 gen(97531);
+
+    // Boxes cycle through five materials, so neighbouring samples land on different ones
+    std::vector<std::shared_ptr<Material>> materials;
+    materials.push_back(std::make_shared<PrincipledBSDF>(Vec3(0.7, 0.7, 0.7), 0.6f, 0.0f));
+    materials.push_back(std::make_shared<PrincipledBSDF>(Vec3(0.8, 0.3, 0.2), 0.3f, 0.0f));
+    auto coated = std::make_shared<PrincipledBSDF>(Vec3(0.2, 0.3, 0.8), 0.5f, 0.0f);
+    coated->setClearcoat(1.0f, 0.05f);
+    materials.push_back(coated);
+    materials.push_back(std::make_shared<Metal>(Vec3(0.8, 0.8, 0.8), 0.3f, 1.0f, 0.0f, 0.0f));
+    materials.push_back(std::make_shared<Dielectric>(1.5));
+    HittableList world = occluder_scene(1024, 1.0f, gen, materials);
+    auto bvh = std::make_shared<ParallelBVHNode>(world.objects, 0, world.objects.size(), 0.0, 1.0);
+    scene_materials.compile();
+
+    const int width = 160, height = 90, spp = 4;
+    Renderer renderer(width, height, MAX_DEPTH, spp);
+    renderer.set_settings(settings);
+    renderer.camera = Camera(Vec3(0, 14, 28), Vec3(0, 0, 0), Vec3(0, 1, 0), 40.0, double(width) / height, 0.0, 30.0, 6);
+    auto lights = random_lights(16, gen);
+    renderer.build_light_sampling(lights, 30.0f);
+    if (settings.sun_cache)
+        renderer.sun_cache.build(world.objects, renderer.light_table);
+    const Vec3SIMD background(0.2f, 0.25f, 0.3f);
+    const size_t samples = size_t(width) * height * spp;
+
+    std::cout << "wavefront: " << width << "x" << height << " at " << spp << " spp, " << world.size()
+        << " triangles, " << materials.size() << " materials, " << lights.size() << " lights, one thread" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    // ray_color per sample, in render_chunk's order
+    double sum = 0.0;
+    auto start = bench_clock::now();
+    for (int j = height - 1; j >= 0; --j) {
+        for (int i = 0; i < width; ++i) {
+            for (int s = 0; s < spp; ++s) {
+                Vec2 uv = renderer.stratified_halton(i, j, 0, spp);
+                PathAOV aov;
+                Vec3SIMD color = renderer.ray_color(renderer.camera.get_ray(uv.u, uv.v), bvh.get(), lights, background, &aov);
+                sum += color.x() + color.y() + color.z();
+            }
+        }
+    }
+    double megakernel_ns = ns_per(start, samples);
+    std::cout << "  megakernel          " << std::setw(8) << megakernel_ns << " ns/sample  "
+        << std::setw(7) << 1e6 / megakernel_ns << " Ksamples/s  mean " << std::setprecision(4) << sum / (3.0 * samples)
+        << std::setprecision(1) << std::endl;
+
+    for (bool sorted : { false, true }) {
+        WavefrontIntegrator integrator;
+        integrator.sort_by_material = sorted;
+        sum = 0.0;
+        start = bench_clock::now();
+        integrator.render_rows(renderer, bvh.get(), background, 0, height - 1, spp,
+            [&](int, int, const PixelSums& pixel) { sum += pixel.color.x() + pixel.color.y() + pixel.color.z(); });
+        double wavefront_ns = ns_per(start, samples);
+        const WavefrontIntegrator::Stats& stats = integrator.stats();
+        std::cout << "  wavefront " << (sorted ? "sorted  " : "unsorted") << "  " << std::setw(8) << wavefront_ns << " ns/sample  "
+            << std::setw(7) << 1e6 / wavefront_ns << " Ksamples/s  mean " << std::setprecision(4) << sum / (3.0 * samples)
+            << std::setprecision(1) << "  (" << std::setprecision(2) << megakernel_ns / std::max(wavefront_ns, 1e-3) << "x)"
+            << std::setprecision(1) << "  material switches " << 1000.0 * stats.material_switches / std::max<size_t>(stats.vertices, 1)
+            << " per 1k hits, " << double(stats.shadow_rays) / samples << " shadow rays/sample" << std::endl;
+    }
+    return 0;
+}
+
+int Benchmark::roulette(const RenderSettings& settings) {
+    std::mt19937 gen(24680);
+
+    // Bright boxes in a closed 40 x 8 x 40 room, so most of the light reaching
+    // a pixel has bounced several times
+    std::vector<std::shared_ptr<Material>> materials;
+    materials.push_back(std::make_shared<PrincipledBSDF>(Vec3(0.8, 0.8, 0.8), 0.7f, 0.0f));
+    materials.push_back(std::make_shared<PrincipledBSDF>(Vec3(0.85, 0.6, 0.4), 0.5f, 0.0f));
+    HittableList world = occluder_scene(512, 1.5f, gen, materials);
+    // Ceiling and four walls close the room; nothing escapes to the background
+    const Vec3SIMD corners[8] = { Vec3SIMD(-20, 0, -20), Vec3SIMD(20, 0, -20), Vec3SIMD(20, 0, 20), Vec3SIMD(-20, 0, 20),
+                                  Vec3SIMD(-20, 8, -20), Vec3SIMD(20, 8, -20), Vec3SIMD(20, 8, 20), Vec3SIMD(-20, 8, 20) };
+    const int faces[5][4] = { { 4, 5, 6, 7 }, { 0, 1, 5, 4 }, { 1, 2, 6, 5 }, { 2, 3, 7, 6 }, { 3, 0, 4, 7 } };
+    for (const auto& face : faces) {
+        world.add(std::make_shared<Triangle>(corners[face[0]], corners[face[1]], corners[face[2]], materials[0]));
+        world.add(std::make_shared<Triangle>(corners[face[0]], corners[face[2]], corners[face[3]], materials[0]));
+    }
+    auto bvh = std::make_shared<ParallelBVHNode>(world.objects, 0, world.objects.size(), 0.0, 1.0);
+    scene_materials.compile();
+
+    const int width = 96, height = 54, spp = 32;
+    Renderer renderer(width, height, MAX_DEPTH, spp);
+    renderer.camera = Camera(Vec3(0, 5, 18), Vec3(0, 1, 0), Vec3(0, 1, 0), 50.0, double(width) / height, 0.0, 30.0, 6);
+    // A 6 x 6 ceiling panel facing down and two point lights
+    std::vector<std::shared_ptr<Light>> lights;
+    lights.push_back(std::make_shared<AreaLight>(Vec3SIMD(-3, 7.9f, -3), Vec3SIMD(1, 0, 0), Vec3SIMD(0, 0, 1), 6.0, 6.0, Vec3SIMD(12, 12, 12)));
+    lights.push_back(std::make_shared<PointLight>(Vec3SIMD(-10, 5, 5), Vec3SIMD(20, 18, 15), 0.0f));
+    lights.push_back(std::make_shared<PointLight>(Vec3SIMD(10, 5, -5), Vec3SIMD(15, 18, 20), 0.0f));
+    renderer.build_light_sampling(lights, 30.0f);
+    const Vec3SIMD background(0.0f, 0.0f, 0.0f);
+    const size_t samples = size_t(width) * height * spp;
+
+    std::cout << "roulette: " << width << "x" << height << " at " << spp << " spp, " << world.size()
+        << " triangles, " << lights.size() << " lights, one thread" << std::endl;
+    std::cout << "  variance is per sample and pixel, averaged over pixels; equal variance means the\n"
+        << "  variance of the depth-cap-only render at " << spp << " spp" << std::endl;
+    std::cout << std::fixed;
+
+    struct Policy {
+        const char* name;
+        float threshold;
+    };
+    const Policy policies[] = {
+        { "depth cap only ", 0.0f },
+        { "threshold 1.0  ", 1.0f },
+        { "threshold 0.5  ", 0.5f },
+        { "threshold 0.25 ", 0.25f },
+        { "threshold 0.1  ", 0.1f },
+    };
+    double reference_variance = 0.0;
+    double reference_ns = 0.0;
+    for (const Policy& policy : policies) {
+        RenderSettings policy_settings = settings;
+        policy_settings.roulette_threshold = policy.threshold;
+        renderer.set_settings(policy_settings);
+
+        WavefrontIntegrator integrator;
+        double mean = 0.0, variance = 0.0;
+        auto start = bench_clock::now();
+        integrator.render_rows(renderer, bvh.get(), background, 0, height - 1, spp,
+            [&](int, int, const PixelSums& pixel) {
+                const double sum = luminance(pixel.color);
+                mean += sum;
+                variance += std::max(0.0, (pixel.luminance_sq - sum * sum / spp) / (spp - 1));
+            });
+        const double ns = ns_per(start, samples);
+        mean /= samples;
+        variance /= double(width) * height;
+
+        const WavefrontIntegrator::Stats& stats = integrator.stats();
+        const double rays = double(stats.extension_rays + stats.shadow_rays) / samples;
+        if (reference_variance == 0.0) {
+            reference_variance = variance;
+            reference_ns = ns;
+        }
+        // Samples per pixel that bring this policy's pixel variance down to the reference's
+        const double equal_spp = spp * variance / std::max(reference_variance, 1e-12);
+        std::cout << "  " << policy.name << std::setprecision(2) << std::setw(6) << double(stats.extension_rays) / samples
+            << " bounces + " << std::setw(5) << double(stats.shadow_rays) / samples << " shadow rays/sample  "
+            << std::setprecision(4) << "mean " << mean << "  variance " << variance
+            << std::setprecision(1) << "  " << std::setw(6) << rays * equal_spp << " rays/px at equal variance  "
+            << std::setprecision(2) << ns * equal_spp / (reference_ns * spp) << "x time" << std::endl;
+    }
+    return 0;
+}
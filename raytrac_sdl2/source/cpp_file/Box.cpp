@@ -2,7 +2,7 @@
 
 Box::Box() {}
 Box::Box(const Vec3& position, double size, std::shared_ptr<Material> mat)
-    : center(position), size(size), material(mat) {}
+    : center(position), size(size), material_id(scene_materials.add(mat)) {}
 
 Vec3 Box::min() const {
     return center - Vec3(size / 2, size / 2, size / 2);
@@ -64,7 +64,8 @@ bool Box::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
             outward_normal.z = relative_pos.z > 0 ? 1 : -1;
 
         rec.set_face_normal(r, outward_normal);
-        rec.material = material;
+        rec.material_id = material_id;
+        rec.light_index = -1;
         return true;
     }
 
@@ -0,0 +1,100 @@
+#include "Denoiser.h"
+#include <iostream>
+#include <chrono>
+
+bool Denoiser::create_device(int num_threads) {
+    // CUDA is probed once per denoiser instead of once per pass.
+    try {
+        device = oidn::newDevice(oidn::DeviceType::CUDA);
+        if (device)
+            device.commit();
+    }
+    catch (const std::exception&) {
+        device = oidn::DeviceRef();
+    }
+
+    const char* errorMessage;
+    if (!device || device.getError(errorMessage) != oidn::Error::None) {
+        std::cout << "OIDN: CUDA device not available, using CPU device." << std::endl;
+        device = oidn::newDevice(oidn::DeviceType::CPU);
+        if (!device) {
+            std::cerr << "OIDN device could not be created, denoising disabled." << std::endl;
+            device_failed = true;
+            return false;
+        }
+        device.set("numThreads", num_threads);
+        device.commit();
+    }
+
+    device_ready = true;
+    return true;
+}
+
+bool Denoiser::prepare(int width, int height, int num_threads) {
+    if (device_failed)
+        return false;
+    if (!device_ready && !create_device(num_threads))
+        return false;
+    if (width == buffer_width && height == buffer_height && filter)
+        return true;
+
+    const size_t bytes = static_cast<size_t>(width) * height * 3 * sizeof(float);
+    color_buffer = device.newBuffer(bytes);
+    albedo_buffer = device.newBuffer(bytes);
+    normal_buffer = device.newBuffer(bytes);
+    output_buffer = device.newBuffer(bytes);
+    host_output.assign(static_cast<size_t>(width) * height * 3, 0.0f);
+
+    filter = device.newFilter("RT");
+    filter.setImage("color", color_buffer, oidn::Format::Float3, width, height);
+    filter.setImage("albedo", albedo_buffer, oidn::Format::Float3, width, height);
+    filter.setImage("normal", normal_buffer, oidn::Format::Float3, width, height);
+    filter.setImage("output", output_buffer, oidn::Format::Float3, width, height);
+    // Input comes straight from the linear float accumulation buffer.
+    filter.set("hdr", true);
+    // Aux images are first-hit values averaged per pixel, no prefiltering pass.
+    filter.set("cleanAux", true);
+    filter.commit();
+
+    const char* errorMessage;
+    if (device.getError(errorMessage) != oidn::Error::None) {
+        std::cerr << "OIDN error: " << errorMessage << std::endl;
+        filter = oidn::FilterRef();
+        return false;
+    }
+
+    buffer_width = width;
+    buffer_height = height;
+    return true;
+}
+
+bool Denoiser::denoise(const float* color, const float* albedo, const float* normal) {
+    if (!filter)
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+    const size_t bytes = host_output.size() * sizeof(float);
+    // write/read work for host and device (CUDA) buffers alike
+    color_buffer.write(0, bytes, color);
+    albedo_buffer.write(0, bytes, albedo);
+    normal_buffer.write(0, bytes, normal);
+    filter.execute();
+    output_buffer.read(0, bytes, host_output.data());
+
+    const char* errorMessage;
+    if (device.getError(errorMessage) != oidn::Error::None) {
+        std::cerr << "OIDN error: " << errorMessage << std::endl;
+        return false;
+    }
+
+    last_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    total_duration += last_duration;
+    return true;
+}
+
+bool Denoiser::within_budget(double seconds_since_last, float budget_fraction) const {
+    // No measurement yet: run once so the cost becomes known.
+    if (last_duration <= 0.0)
+        return true;
+    return last_duration <= seconds_since_last * budget_fraction;
+}
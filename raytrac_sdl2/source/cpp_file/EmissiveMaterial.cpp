@@ -7,6 +7,16 @@ bool EmissiveMaterial::scatter(const Ray& r_in, const HitRecord& rec, Vec3SIMD&
     return false; // Emissive materials do not scatter light
 }
 
+bool EmissiveMaterial::sample(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered, float& pdf) const {
+    pdf = 0.0f;
+    return false;
+}
+
+Vec3SIMD EmissiveMaterial::eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi, float& pdf) const {
+    pdf = 0.0f;
+    return Vec3SIMD(0, 0, 0);
+}
+
 Vec3SIMD EmissiveMaterial::emitted(double u, double v, const Vec3SIMD& p) const {
     return emission;
 }
@@ -0,0 +1,131 @@
+#include "EnvironmentLight.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float kPi = static_cast<float>(M_PI);
+
+    float luminance(const Vec3& c) {
+        return static_cast<float>(0.2126 * c.x + 0.7152 * c.y + 0.0722 * c.z);
+    }
+
+    // Index i with cdf[i] <= u < cdf[i + 1]; cdf has n + 1 entries.
+    int find_interval(const float* cdf, int n, float u) {
+        const float* it = std::upper_bound(cdf, cdf + n + 1, u);
+        return std::clamp(static_cast<int>(it - cdf) - 1, 0, n - 1);
+    }
+}
+
+EnvironmentLight::EnvironmentLight(std::shared_ptr<Texture> tex) : texture(std::move(tex)) {
+    if (!texture || texture->get_width() <= 0 || texture->get_height() <= 0)
+        return;
+
+    // Texture::get_color picks texel floor(u * (width - 1)), so the last
+    // column and row are never reached except at u or v == 1
+    cols = std::max(1, texture->get_width() - 1);
+    rows = std::max(1, texture->get_height() - 1);
+    func.resize(static_cast<size_t>(rows) * cols);
+    conditional.resize(static_cast<size_t>(rows) * (cols + 1));
+    marginal.resize(rows + 1);
+
+    double luminance_sum = 0.0, weight_sum = 0.0;
+    for (int y = 0; y < rows; ++y) {
+        // Row y spans s = 1 - v in [y, y + 1) / rows; elevation = pi * (s - 0.5)
+        float elevation = kPi * ((y + 0.5f) / rows - 0.5f);
+        float cos_e = std::cos(elevation);
+        float* row_cdf = &conditional[static_cast<size_t>(y) * (cols + 1)];
+        row_cdf[0] = 0.0f;
+        for (int x = 0; x < cols; ++x) {
+            float lum = luminance(texture->texel(x, y));
+            luminance_sum += lum * cos_e;
+            weight_sum += cos_e;
+            float f = std::max(lum, 0.0f) * cos_e;
+            func[static_cast<size_t>(y) * cols + x] = f;
+            row_cdf[x + 1] = row_cdf[x] + f / cols;
+        }
+        marginal[y + 1] = marginal[y] + row_cdf[cols] / rows;
+    }
+    total = marginal[rows];
+    mean_luminance = weight_sum > 0.0 ? static_cast<float>(luminance_sum / weight_sum) : 0.0f;
+    if (total <= 0.0f)
+        return;
+
+    for (int y = 0; y < rows; ++y) {
+        float* row_cdf = &conditional[static_cast<size_t>(y) * (cols + 1)];
+        float row_total = row_cdf[cols];
+        for (int x = 1; x <= cols; ++x)
+            row_cdf[x] = row_total > 0.0f ? row_cdf[x] / row_total : float(x) / cols;
+    }
+    for (int y = 1; y <= rows; ++y)
+        marginal[y] /= total;
+}
+
+void EnvironmentLight::direction_to_uv(const Vec3SIMD& direction, float& u, float& s) const {
+    // Same mapping as the renderer's background lookup: v = 0.5 - asin(y) / pi
+    u = 0.5f + std::atan2(direction.z(), direction.x()) / (2.0f * kPi);
+    s = 0.5f + std::asin(std::clamp(direction.y(), -1.0f, 1.0f)) / kPi;
+}
+
+Vec3SIMD EnvironmentLight::radiance(const Vec3SIMD& direction) const {
+    if (!texture)
+        return Vec3SIMD(0.0f, 0.0f, 0.0f);
+    float u, s;
+    direction_to_uv(direction.normalize(), u, s);
+    return texture->get_color(u, 1.0f - s);
+}
+
+float EnvironmentLight::pdf_uv(int x, int y, float s) const {
+    // Density over (u, s) to solid angle: d_omega = 2 pi * pi * cos(elevation) du ds
+    float cos_e = std::cos(kPi * (s - 0.5f));
+    if (cos_e <= 1e-6f)
+        return 0.0f;
+    return func[static_cast<size_t>(y) * cols + x] / total / (2.0f * kPi * kPi * cos_e);
+}
+
+float EnvironmentLight::pdf(const Vec3SIMD& direction) const {
+    if (!valid())
+        return 0.0f;
+    float u, s;
+    direction_to_uv(direction, u, s);
+    int x = std::clamp(static_cast<int>(u * cols), 0, cols - 1);
+    int y = std::clamp(static_cast<int>(s * rows), 0, rows - 1);
+    return pdf_uv(x, y, s);
+}
+
+bool EnvironmentLight::sample(float u1, float u2, Vec3SIMD& direction, float& pdf) const {
+    if (!valid())
+        return false;
+    int y = find_interval(marginal.data(), rows, u1);
+    float dy = (u1 - marginal[y]) / std::max(marginal[y + 1] - marginal[y], 1e-12f);
+    const float* row_cdf = &conditional[static_cast<size_t>(y) * (cols + 1)];
+    int x = find_interval(row_cdf, cols, u2);
+    float dx = (u2 - row_cdf[x]) / std::max(row_cdf[x + 1] - row_cdf[x], 1e-12f);
+
+    float u = (x + std::clamp(dx, 0.0f, 1.0f)) / cols;
+    float s = (y + std::clamp(dy, 0.0f, 1.0f)) / rows;
+    pdf = pdf_uv(x, y, s);
+    if (pdf <= 0.0f)
+        return false;
+
+    float phi = 2.0f * kPi * (u - 0.5f);
+    float elevation = kPi * (s - 0.5f);
+    float cos_e = std::cos(elevation);
+    direction = Vec3SIMD(cos_e * std::cos(phi), std::sin(elevation), cos_e * std::sin(phi));
+    return true;
+}
+
+Vec3SIMD EnvironmentLight::getDirection(const Vec3SIMD& point) const {
+    return Vec3SIMD(0.0f, 1.0f, 0.0f);
+}
+
+Vec3SIMD EnvironmentLight::getIntensity(const Vec3SIMD& point) const {
+    return Vec3SIMD(mean_luminance, mean_luminance, mean_luminance);
+}
+
+Vec3SIMD EnvironmentLight::random_point() const {
+    Vec3SIMD direction;
+    float pdf;
+    if (!sample(static_cast<float>(Vec3SIMD::random_double()), static_cast<float>(Vec3SIMD::random_double()), direction, pdf))
+        return Vec3SIMD(0.0f, 1e5f, 0.0f);
+    return direction * 1e5f;
+}
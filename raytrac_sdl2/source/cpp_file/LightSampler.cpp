@@ -0,0 +1,36 @@
+#include "LightSampler.h"
+#include "PointLight.h"
+#include "DirectionalLight.h"
+#include "SpotLight.h"
+#include "AreaLight.h"
+#include "TriangleLight.h"
+#include "EnvironmentLight.h"
+#include <cmath>
+
+static float luminance(const Vec3SIMD& c) {
+    return 0.2126f * c.x() + 0.7152f * c.y() + 0.0722f * c.z();
+}
+
+float LightSampler::power(const Light& light, float scene_radius) {
+    switch (light.type()) {
+    case LightType::Point:
+        return 4.0f * static_cast<float>(M_PI) * luminance(static_cast<const PointLight&>(light).getIntensity());
+    case LightType::Spot: {
+        const SpotLight& spot = static_cast<const SpotLight&>(light);
+        return 2.0f * static_cast<float>(M_PI) * (1.0f - spot.cos_cone) * luminance(spot.intensity);
+    }
+    case LightType::Area:
+        // Lambertian emitter shaded from both faces (LightTable uses |cos|): pi per side
+        return 2.0f * static_cast<float>(M_PI) * luminance(static_cast<const AreaLight&>(light).getIntensity());
+    case LightType::Triangle:
+        // intensity is radiance * area, emitted from both faces like a quad
+        return 2.0f * static_cast<float>(M_PI) * luminance(light.intensity);
+    case LightType::Directional:
+        return static_cast<float>(M_PI) * scene_radius * scene_radius * luminance(light.intensity);
+    case LightType::Environment:
+        // Like a sun whose irradiance is pi * mean radiance
+        return static_cast<float>(M_PI * M_PI) * scene_radius * scene_radius *
+            static_cast<const EnvironmentLight&>(light).average_luminance();
+    }
+    return 0.0f;
+}
@@ -0,0 +1,281 @@
+#include "LightTable.h"
+#include "PointLight.h"
+#include "DirectionalLight.h"
+#include "SpotLight.h"
+#include "AreaLight.h"
+#include "TriangleLight.h"
+#include "EnvironmentLight.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr float kPi = static_cast<float>(M_PI);
+    // Spherical triangle sampling pays off between these solid angles; below
+    // it area sampling is just as good, above it the float math breaks down.
+    constexpr float min_spherical_solid_angle = 3e-4f;
+    constexpr float max_spherical_solid_angle = 6.22f;
+
+    // Solid angle of the triangle seen from p (Van Oosterom & Strackee).
+    float spherical_triangle_area(const Vec3SIMD& a, const Vec3SIMD& b, const Vec3SIMD& c) {
+        float num = std::abs(a.dot(Vec3SIMD::cross(b, c)));
+        float den = 1.0f + a.dot(b) + b.dot(c) + c.dot(a);
+        return std::abs(2.0f * std::atan2(num, den));
+    }
+
+    float angle_between(const Vec3SIMD& v1, const Vec3SIMD& v2) {
+        if (v1.dot(v2) < 0.0f)
+            return kPi - 2.0f * std::asin(std::min(1.0f, (v1 + v2).length() * 0.5f));
+        return 2.0f * std::asin(std::min(1.0f, (v2 - v1).length() * 0.5f));
+    }
+
+    Vec3SIMD gram_schmidt(const Vec3SIMD& v, const Vec3SIMD& w) {
+        return v - w * v.dot(w);
+    }
+
+    // Arvo's uniform sampling of the spherical triangle with unit corners a, b, c.
+    bool sample_spherical_triangle(const Vec3SIMD& a, const Vec3SIMD& b, const Vec3SIMD& c, float u1, float u2, Vec3SIMD& w) {
+        Vec3SIMD n_ab = Vec3SIMD::cross(a, b), n_bc = Vec3SIMD::cross(b, c), n_ca = Vec3SIMD::cross(c, a);
+        if (n_ab.length_squared() == 0.0f || n_bc.length_squared() == 0.0f || n_ca.length_squared() == 0.0f)
+            return false;
+        n_ab = n_ab.normalize();
+        n_bc = n_bc.normalize();
+        n_ca = n_ca.normalize();
+
+        const float alpha = angle_between(n_ab, -n_ca);
+        const float beta = angle_between(n_bc, -n_ab);
+        const float gamma = angle_between(n_ca, -n_bc);
+
+        // Pick the sub-triangle area, then the point along the arc towards b
+        const float area_pi = alpha + beta + gamma;
+        const float sub_area_pi = kPi + u1 * (area_pi - kPi);
+        const float cos_alpha = std::cos(alpha), sin_alpha = std::sin(alpha);
+        const float sin_phi = std::sin(sub_area_pi) * cos_alpha - std::cos(sub_area_pi) * sin_alpha;
+        const float cos_phi = std::cos(sub_area_pi) * cos_alpha + std::sin(sub_area_pi) * sin_alpha;
+        const float k1 = cos_phi + cos_alpha;
+        const float k2 = sin_phi - sin_alpha * a.dot(b);
+        float cos_bp = (k2 + (k2 * cos_phi - k1 * sin_phi) * cos_alpha) / ((k2 * sin_phi + k1 * cos_phi) * sin_alpha);
+        cos_bp = std::clamp(cos_bp, -1.0f, 1.0f);
+        const float sin_bp = std::sqrt(std::max(0.0f, 1.0f - cos_bp * cos_bp));
+        const Vec3SIMD c_prime = a * cos_bp + gram_schmidt(c, a).normalize() * sin_bp;
+
+        const float cos_theta = 1.0f - u2 * (1.0f - c_prime.dot(b));
+        const float sin_theta = std::sqrt(std::max(0.0f, 1.0f - cos_theta * cos_theta));
+        w = (b * cos_theta + gram_schmidt(c_prime, b).normalize() * sin_theta).normalize();
+        return true;
+    }
+}
+
+void LightTable::build(const std::vector<std::shared_ptr<Light>>& lights) {
+    const size_t n = lights.size();
+    type.resize(n);
+    position.assign(n, Vec3SIMD(0, 0, 0));
+    direction.assign(n, Vec3SIMD(0, 0, 0));
+    intensity.assign(n, Vec3SIMD(0, 0, 0));
+    edge_u.assign(n, Vec3SIMD(0, 0, 0));
+    edge_v.assign(n, Vec3SIMD(0, 0, 0));
+    cos_cone.assign(n, -1.0f);
+    radius.assign(n, 0.0f);
+    area.assign(n, 0.0f);
+    inv_area.assign(n, 0.0f);
+    area_indices.clear();
+    environment = nullptr;
+    environment_index = -1;
+
+    // The only place that looks at the concrete light classes
+    for (size_t i = 0; i < n; ++i) {
+        const Light& light = *lights[i];
+        type[i] = light.type();
+        switch (type[i]) {
+        case LightType::Directional: {
+            const DirectionalLight& directional = static_cast<const DirectionalLight&>(light);
+            direction[i] = directional.direction;
+            intensity[i] = directional.intensity;
+            radius[i] = static_cast<float>(directional.getRadius());
+            break;
+        }
+        case LightType::Point: {
+            const PointLight& point = static_cast<const PointLight&>(light);
+            position[i] = point.getPosition();
+            intensity[i] = point.getIntensity();
+            radius[i] = point.getRadius();
+            break;
+        }
+        case LightType::Spot: {
+            const SpotLight& spot = static_cast<const SpotLight&>(light);
+            position[i] = spot.position;
+            direction[i] = spot.direction.normalize();
+            intensity[i] = spot.intensity;
+            cos_cone[i] = spot.cos_cone;
+            radius[i] = spot.radius;
+            break;
+        }
+        case LightType::Area: {
+            const AreaLight& quad = static_cast<const AreaLight&>(light);
+            position[i] = quad.getPosition();
+            edge_u[i] = quad.getU() * static_cast<float>(quad.getWidth());
+            edge_v[i] = quad.getV() * static_cast<float>(quad.getHeight());
+            Vec3SIMD n_area = edge_u[i].cross(edge_v[i]);
+            area[i] = n_area.length();
+            inv_area[i] = area[i] > 0.0f ? 1.0f / area[i] : 0.0f;
+            direction[i] = area[i] > 0.0f ? n_area / area[i] : Vec3SIMD(0, 1, 0);
+            intensity[i] = quad.getIntensity();
+            if (area[i] > 0.0f)
+                area_indices.push_back(static_cast<int>(i));
+            break;
+        }
+        case LightType::Triangle: {
+            // Already in the BVH, so not added to area_indices
+            const TriangleLight& triangle = static_cast<const TriangleLight&>(light);
+            position[i] = triangle.getVertex(0);
+            edge_u[i] = triangle.getVertex(1) - triangle.getVertex(0);
+            edge_v[i] = triangle.getVertex(2) - triangle.getVertex(0);
+            direction[i] = triangle.getNormal();
+            area[i] = triangle.getArea();
+            inv_area[i] = area[i] > 0.0f ? 1.0f / area[i] : 0.0f;
+            intensity[i] = triangle.intensity;
+            break;
+        }
+        case LightType::Environment:
+            environment = &static_cast<const EnvironmentLight&>(light);
+            environment_index = static_cast<int>(i);
+            break;
+        }
+    }
+}
+
+bool LightTable::sample_direction(int i, const Vec3SIMD& point, float u1, float u2, Vec3SIMD& to_light, float& distance) const {
+    switch (type[i]) {
+    case LightType::Directional: {
+        // Same jitter as DirectionalLight::random_point: a disk offset at 1000 units
+        float angle = 2.0f * static_cast<float>(M_PI) * u1;
+        float r = radius[i] * u2;
+        Vec3SIMD sun = direction[i] * 1000.0f + Vec3SIMD(r * std::cos(angle), r * std::sin(angle), 0.0f);
+        to_light = -sun.normalize();
+        distance = std::numeric_limits<float>::infinity();
+        return true;
+    }
+    case LightType::Environment: {
+        float pdf;
+        distance = std::numeric_limits<float>::infinity();
+        return environment->sample(u1, u2, to_light, pdf);
+    }
+    case LightType::Point:
+    case LightType::Spot:
+        to_light = position[i] - point;
+        break;
+    case LightType::Area:
+        to_light = position[i] + edge_u[i] * u1 + edge_v[i] * u2 - point;
+        break;
+    case LightType::Triangle: {
+        const Vec3SIMD a = position[i] - point;
+        const Vec3SIMD b = a + edge_u[i];
+        const Vec3SIMD c = a + edge_v[i];
+        const float d_a = a.length(), d_b = b.length(), d_c = c.length();
+        if (d_a <= 0.0f || d_b <= 0.0f || d_c <= 0.0f)
+            return false;
+        const Vec3SIMD ua = a / d_a, ub = b / d_b, uc = c / d_c;
+        const float solid_angle = spherical_triangle_area(ua, ub, uc);
+        if (solid_angle > min_spherical_solid_angle && solid_angle < max_spherical_solid_angle) {
+            // Close, large triangle: uniform in solid angle, then find the plane
+            Vec3SIMD w;
+            if (!sample_spherical_triangle(ua, ub, uc, u1, u2, w))
+                return false;
+            float denom = w.dot(direction[i]);
+            if (std::abs(denom) < 1e-8f)
+                return false;
+            distance = a.dot(direction[i]) / denom;
+            if (distance <= 0.0f)
+                return false;
+            to_light = w;
+            return true;
+        }
+        // Uniform by area
+        const float su = std::sqrt(u1);
+        to_light = a + edge_u[i] * (su * (1.0f - u2)) + edge_v[i] * (su * u2);
+        break;
+    }
+    default:
+        return false;
+    }
+    distance = to_light.length();
+    if (distance <= 0.0f)
+        return false;
+    to_light = to_light / distance;
+    return true;
+}
+
+Vec3SIMD LightTable::incident(int i, const Vec3SIMD& point, const Vec3SIMD& to_light, float distance) const {
+    switch (type[i]) {
+    case LightType::Directional:
+        return intensity[i];
+    case LightType::Point:
+        return intensity[i] / (distance * distance);
+    case LightType::Area:
+    case LightType::Triangle: {
+        // radiance / pdf; for a quad this is intensity * cos_l / d^2
+        float pdf = solid_angle_pdf(i, point, to_light, distance);
+        return pdf > 0.0f ? radiance(i) / pdf : Vec3SIMD(0.0f, 0.0f, 0.0f);
+    }
+    case LightType::Environment: {
+        float pdf = environment->pdf(to_light);
+        return pdf > 0.0f ? environment->radiance(to_light) / pdf : Vec3SIMD(0.0f, 0.0f, 0.0f);
+    }
+    case LightType::Spot: {
+        // Spot emits along its direction; to_light points back at it
+        float cos_theta = -to_light.dot(direction[i]);
+        if (cos_theta <= cos_cone[i])
+            return Vec3SIMD(0.0f, 0.0f, 0.0f);
+        float falloff = cos_theta * cos_theta;   // Cosine falloff, exponent 2
+        return intensity[i] * falloff / (distance * distance);
+    }
+    }
+    return Vec3SIMD(0.0f, 0.0f, 0.0f);
+}
+
+float LightTable::solid_angle_pdf(int i, const Vec3SIMD& point, const Vec3SIMD& to_light, float distance) const {
+    if (type[i] == LightType::Environment)
+        return environment->pdf(to_light);
+    if (type[i] != LightType::Area && type[i] != LightType::Triangle)
+        return 0.0f;
+    if (type[i] == LightType::Triangle) {
+        const Vec3SIMD a = position[i] - point;
+        const Vec3SIMD b = a + edge_u[i];
+        const Vec3SIMD c = a + edge_v[i];
+        const float solid_angle = spherical_triangle_area(a.normalize(), b.normalize(), c.normalize());
+        if (solid_angle > min_spherical_solid_angle && solid_angle < max_spherical_solid_angle)
+            return 1.0f / solid_angle;
+    }
+    float cos_l = std::abs(to_light.dot(direction[i]));
+    if (cos_l <= 1e-6f)
+        return 0.0f;
+    return distance * distance * inv_area[i] / cos_l;
+}
+
+bool LightTable::intersect(const Ray& ray, float t_max, int& index, float& t) const {
+    index = -1;
+    t = t_max;
+    const Vec3SIMD dir = ray.direction;
+    for (int i : area_indices) {
+        const Vec3SIMD& n = direction[i];
+        float denom = dir.dot(n);
+        if (std::abs(denom) < 1e-8f)
+            continue;
+        float t_hit = (position[i] - ray.origin).dot(n) / denom;
+        if (t_hit <= 1e-4f || t_hit >= t)
+            continue;
+
+        // Solve p = a * edge_u + b * edge_v in the quad plane
+        Vec3SIMD p = ray.origin + dir * t_hit - position[i];
+        Vec3SIMD n_area = n * area[i];
+        float inv_len2 = inv_area[i] * inv_area[i];
+        float a = p.cross(edge_v[i]).dot(n_area) * inv_len2;
+        float b = edge_u[i].cross(p).dot(n_area) * inv_len2;
+        if (a < 0.0f || a > 1.0f || b < 0.0f || b > 1.0f)
+            continue;
+
+        index = i;
+        t = t_hit;
+    }
+    return index >= 0;
+}
@@ -0,0 +1,295 @@
+#include "LightTree.h"
+#include "PointLight.h"
+#include "SpotLight.h"
+#include "AreaLight.h"
+#include "TriangleLight.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float kPi = static_cast<float>(M_PI);
+
+    float safe_acos(float c) { return std::acos(std::clamp(c, -1.0f, 1.0f)); }
+    float safe_sqrt(float v) { return std::sqrt(std::max(v, 0.0f)); }
+
+    // cos(a - b) and sin(a - b), clamped to 0 when a < b
+    float cos_sub_clamped(float sin_a, float cos_a, float sin_b, float cos_b) {
+        return cos_a > cos_b ? 1.0f : cos_a * cos_b + sin_a * sin_b;
+    }
+    float sin_sub_clamped(float sin_a, float cos_a, float sin_b, float cos_b) {
+        return cos_a > cos_b ? 0.0f : sin_a * cos_b - cos_a * sin_b;
+    }
+
+    AABB point_box(const Vec3SIMD& p, float radius) {
+        Vec3SIMD r(radius, radius, radius);
+        return AABB(p - r, p + r);
+    }
+
+    AABB merge_boxes(const AABB& a, const AABB& b) {
+        return AABB(Vec3SIMD(std::min(a.min.x(), b.min.x()), std::min(a.min.y(), b.min.y()), std::min(a.min.z(), b.min.z())),
+            Vec3SIMD(std::max(a.max.x(), b.max.x()), std::max(a.max.y(), b.max.y()), std::max(a.max.z(), b.max.z())));
+    }
+
+    // Rodrigues rotation of v around the unit axis k
+    Vec3SIMD rotate(const Vec3SIMD& v, const Vec3SIMD& k, float angle) {
+        float c = std::cos(angle), s = std::sin(angle);
+        return v * c + k.cross(v) * s + k * (k.dot(v) * (1.0f - c));
+    }
+}
+
+float LightBounds::importance(const Vec3SIMD& point) const {
+    const Vec3SIMD center = (bounds.min + bounds.max) * 0.5f;
+    const float radius = 0.5f * (bounds.max - bounds.min).length();
+    Vec3SIMD to_point = point - center;
+    float d2 = to_point.length_squared();
+    // Keeps points inside the bounds from getting unbounded importance
+    d2 = std::max(d2, radius);
+
+    float cos_w = 1.0f;
+    if (to_point.length_squared() > 1e-12f) {
+        cos_w = w.dot(to_point.normalize());
+        if (two_sided)
+            cos_w = std::abs(cos_w);
+    }
+    const float sin_w = safe_sqrt(1.0f - cos_w * cos_w);
+
+    // Angle the bounds subtend as seen from the point
+    float cos_b = -1.0f;
+    if (to_point.length_squared() > radius * radius)
+        cos_b = safe_sqrt(1.0f - radius * radius / to_point.length_squared());
+    const float sin_b = safe_sqrt(1.0f - cos_b * cos_b);
+    const float sin_o = safe_sqrt(1.0f - cos_theta_o * cos_theta_o);
+
+    // theta' = max(0, theta_w - theta_o - theta_b): closest emission direction
+    const float cos_x = cos_sub_clamped(sin_w, cos_w, sin_o, cos_theta_o);
+    const float sin_x = sin_sub_clamped(sin_w, cos_w, sin_o, cos_theta_o);
+    const float cos_p = cos_sub_clamped(sin_x, cos_x, sin_b, cos_b);
+    if (cos_p < cos_theta_e)
+        return 0.0f;
+
+    return phi * std::max(cos_p, 1e-4f) / d2;
+}
+
+LightBounds LightBounds::merge(const LightBounds& a, const LightBounds& b) {
+    if (a.phi <= 0.0f)
+        return b;
+    if (b.phi <= 0.0f)
+        return a;
+
+    LightBounds out;
+    out.bounds = merge_boxes(a.bounds, b.bounds);
+    out.phi = a.phi + b.phi;
+    out.cos_theta_e = std::min(a.cos_theta_e, b.cos_theta_e);
+    out.two_sided = a.two_sided || b.two_sided;
+
+    // Smallest cone containing both cones
+    const float theta_a = safe_acos(a.cos_theta_o);
+    const float theta_b = safe_acos(b.cos_theta_o);
+    const float theta_d = safe_acos(a.w.dot(b.w));
+    if (std::min(theta_d + theta_b, kPi) <= theta_a) {
+        out.w = a.w;
+        out.cos_theta_o = a.cos_theta_o;
+        return out;
+    }
+    if (std::min(theta_d + theta_a, kPi) <= theta_b) {
+        out.w = b.w;
+        out.cos_theta_o = b.cos_theta_o;
+        return out;
+    }
+    const float theta_o = 0.5f * (theta_a + theta_d + theta_b);
+    Vec3SIMD axis = a.w.cross(b.w);
+    if (theta_o >= kPi || axis.length_squared() < 1e-12f) {
+        out.w = a.w;
+        out.cos_theta_o = -1.0f;
+        return out;
+    }
+    out.w = rotate(a.w, axis.normalize(), theta_o - theta_a).normalize();
+    out.cos_theta_o = std::cos(theta_o);
+    return out;
+}
+
+bool LightTree::light_bounds(const Light& light, LightBounds& out) {
+    out = LightBounds();
+    out.phi = LightSampler::power(light, 0.0f);
+    switch (light.type()) {
+    case LightType::Point: {
+        const PointLight& point = static_cast<const PointLight&>(light);
+        out.bounds = point_box(point.getPosition(), 0.0f);
+        out.cos_theta_o = -1.0f;   // emits in every direction
+        out.cos_theta_e = 0.0f;
+        return true;
+    }
+    case LightType::Spot: {
+        const SpotLight& spot = static_cast<const SpotLight&>(light);
+        out.bounds = point_box(spot.position, 0.0f);
+        out.w = spot.direction.normalize();
+        out.cos_theta_o = spot.cos_cone;
+        out.cos_theta_e = 1.0f;    // hard cut-off at the cone
+        return true;
+    }
+    case LightType::Area: {
+        const AreaLight& area = static_cast<const AreaLight&>(light);
+        const Vec3SIMD p0 = area.getPosition();
+        const Vec3SIMD eu = area.getU() * static_cast<float>(area.getWidth());
+        const Vec3SIMD ev = area.getV() * static_cast<float>(area.getHeight());
+        out.bounds = merge_boxes(merge_boxes(point_box(p0, 0.0f), point_box(p0 + eu, 0.0f)),
+            merge_boxes(point_box(p0 + ev, 0.0f), point_box(p0 + eu + ev, 0.0f)));
+        out.w = eu.cross(ev).normalize();
+        out.cos_theta_o = 1.0f;
+        out.cos_theta_e = 0.0f;
+        out.two_sided = true;      // shaded from both sides
+        return true;
+    }
+    case LightType::Triangle: {
+        const TriangleLight& triangle = static_cast<const TriangleLight&>(light);
+        out.bounds = merge_boxes(merge_boxes(point_box(triangle.getVertex(0), 0.0f), point_box(triangle.getVertex(1), 0.0f)),
+            point_box(triangle.getVertex(2), 0.0f));
+        out.w = triangle.getNormal();
+        out.cos_theta_o = 1.0f;
+        out.cos_theta_e = 0.0f;
+        out.two_sided = true;
+        return true;
+    }
+    default:
+        return false;              // directional: no position
+    }
+}
+
+void LightTree::build(const std::vector<std::shared_ptr<Light>>& lights, float) {
+    nodes.clear();
+    infinite_lights.clear();
+    infinite_slot.assign(lights.size(), -1);
+    light_trail.assign(lights.size(), 0);
+    light_depth.assign(lights.size(), -1);
+
+    std::vector<BuildItem> items;
+    items.reserve(lights.size());
+    for (size_t i = 0; i < lights.size(); ++i) {
+        LightBounds bounds;
+        if (!light_bounds(*lights[i], bounds)) {
+            infinite_slot[i] = static_cast<int>(infinite_lights.size());
+            infinite_lights.push_back(static_cast<int>(i));
+            continue;
+        }
+        if (bounds.phi <= 0.0f)
+            continue;              // contributes nothing, never sampled
+        items.push_back({ static_cast<int>(i), bounds, (bounds.bounds.min + bounds.bounds.max) * 0.5f });
+    }
+
+    if (!items.empty()) {
+        nodes.reserve(2 * items.size());
+        build_node(items, 0, items.size(), 0, 0);
+    }
+}
+
+int LightTree::build_node(std::vector<BuildItem>& items, size_t begin, size_t end, uint64_t trail, int depth) {
+    const int node_index = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+
+    // Median splits keep the depth at log2(n), well inside the 64 trail bits
+    if (end - begin == 1) {
+        const BuildItem& item = items[begin];
+        nodes[node_index].bounds = item.bounds;
+        nodes[node_index].index = item.light;
+        nodes[node_index].is_leaf = true;
+        light_trail[item.light] = trail;
+        light_depth[item.light] = depth;
+        return node_index;
+    }
+
+    // Split at the median along the longest axis of the centroids
+    AABB centroid_box(items[begin].centroid, items[begin].centroid);
+    for (size_t i = begin + 1; i < end; ++i)
+        centroid_box = merge_boxes(centroid_box, AABB(items[i].centroid, items[i].centroid));
+    const Vec3SIMD extent = centroid_box.max - centroid_box.min;
+    int axis = 0;
+    if (extent.y() > extent.x())
+        axis = 1;
+    if (extent.z() > extent.get(axis))
+        axis = 2;
+
+    const size_t mid = begin + (end - begin) / 2;
+    std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+        [axis](const BuildItem& a, const BuildItem& b) { return a.centroid.get(axis) < b.centroid.get(axis); });
+
+    const int left = build_node(items, begin, mid, trail, depth + 1);
+    const int right = build_node(items, mid, end, trail | (uint64_t(1) << depth), depth + 1);
+    nodes[node_index].bounds = LightBounds::merge(nodes[left].bounds, nodes[right].bounds);
+    nodes[node_index].index = right;
+    return node_index;
+}
+
+float LightTree::infinite_probability() const {
+    if (infinite_lights.empty())
+        return 0.0f;
+    const float tree = nodes.empty() ? 0.0f : 1.0f;
+    return infinite_lights.size() / (infinite_lights.size() + tree);
+}
+
+int LightTree::sample(float u, const Vec3SIMD& point, float& pdf) const {
+    pdf = 0.0f;
+    const float p_infinite = infinite_probability();
+    if (u < p_infinite) {
+        u /= p_infinite;
+        const int count = static_cast<int>(infinite_lights.size());
+        const int slot = std::min(static_cast<int>(u * count), count - 1);
+        pdf = p_infinite / count;
+        return infinite_lights[slot];
+    }
+    if (nodes.empty())
+        return -1;
+
+    u = std::min((u - p_infinite) / (1.0f - p_infinite), 0.99999994f);
+    float pmf = 1.0f - p_infinite;
+    int node = 0;
+    while (!nodes[node].is_leaf) {
+        const int left = node + 1;
+        const int right = nodes[node].index;
+        const float ci_left = nodes[left].bounds.importance(point);
+        const float ci_right = nodes[right].bounds.importance(point);
+        if (ci_left <= 0.0f && ci_right <= 0.0f)
+            return -1;
+        const float p_left = ci_left / (ci_left + ci_right);
+        if (u < p_left) {
+            node = left;
+            u = std::min(u / p_left, 0.99999994f);
+            pmf *= p_left;
+        }
+        else {
+            node = right;
+            u = std::min((u - p_left) / (1.0f - p_left), 0.99999994f);
+            pmf *= 1.0f - p_left;
+        }
+    }
+    if (nodes[node].bounds.importance(point) <= 0.0f)
+        return -1;
+    pdf = pmf;
+    return nodes[node].index;
+}
+
+float LightTree::pdf(int light_index, const Vec3SIMD& point) const {
+    if (light_index < 0 || light_index >= static_cast<int>(light_trail.size()))
+        return 0.0f;
+    const float p_infinite = infinite_probability();
+    if (infinite_slot[light_index] >= 0)
+        return p_infinite / infinite_lights.size();
+    if (light_depth[light_index] < 0)
+        return 0.0f;
+
+    // Replay the branch decisions sample() made for this light
+    const uint64_t trail = light_trail[light_index];
+    float pmf = 1.0f - p_infinite;
+    int node = 0;
+    for (int depth = 0; !nodes[node].is_leaf; ++depth) {
+        const int left = node + 1;
+        const int right = nodes[node].index;
+        const float ci_left = nodes[left].bounds.importance(point);
+        const float ci_right = nodes[right].bounds.importance(point);
+        if (ci_left <= 0.0f && ci_right <= 0.0f)
+            return 0.0f;
+        const bool go_right = (trail >> depth) & 1;
+        pmf *= (go_right ? ci_right : ci_left) / (ci_left + ci_right);
+        node = go_right ? right : left;
+    }
+    return nodes[node].bounds.importance(point) > 0.0f ? pmf : 0.0f;
+}
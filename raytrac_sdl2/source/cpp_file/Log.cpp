@@ -0,0 +1,45 @@
+#include "Log.h"
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+namespace {
+    std::mutex log_mutex;
+    std::atomic<uint64_t> suppressed_count{ 0 };
+
+    const char* level_name(Log::Level level) {
+        switch (level) {
+        case Log::Level::Trace: return "trace";
+        case Log::Level::Debug: return "debug";
+        case Log::Level::Info:  return "info";
+        case Log::Level::Warn:  return "warn";
+        case Log::Level::Error: return "error";
+        }
+        return "?";
+    }
+
+    // __FILE__ carries the full build path; the file name is enough to find the site
+    const char* base_name(const char* path) {
+        const char* slash = std::strrchr(path, '/');
+        const char* backslash = std::strrchr(path, '\\');
+        const char* last = slash > backslash ? slash : backslash;
+        return last ? last + 1 : path;
+    }
+}
+
+void Log::write(Level level, const char* file, int line, const std::string& message, bool last) {
+    std::ostream& out = level >= Level::Warn ? std::cerr : std::cout;
+    std::lock_guard<std::mutex> lock(log_mutex);
+    out << '[' << level_name(level) << "] " << base_name(file) << ':' << line << ' ' << message;
+    if (last)
+        out << " (further messages from here suppressed)";
+    out << std::endl;
+}
+
+uint64_t Log::suppressed() {
+    return suppressed_count.load(std::memory_order_relaxed);
+}
+
+void Log::note_suppressed() {
+    suppressed_count.fetch_add(1, std::memory_order_relaxed);
+}
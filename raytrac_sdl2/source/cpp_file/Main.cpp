@@ -1,9 +1,13 @@
 #include <SDL_main.h> 
 #include <fstream>
 #include <locale>
+#include <filesystem>
 #include <SDL_image.h>
 #include "Renderer.h"
 #include "CPUInfo.h"
+#include "RenderSettings.h"
+#include "SceneLoader.h"
+#include "Benchmark.h"
 
 std::shared_ptr<ParallelBVHNode> build_bvh(const std::vector<std::shared_ptr<Hittable>>& objects, double time0, double time1) {
     return std::make_shared<ParallelBVHNode>(objects, 0, objects.size(), time0, time1);
@@ -31,6 +35,13 @@ bool SaveSurface(SDL_Surface* surface, const char* file_path) {
     return true;
 }
 
+// "render.png" -> "render_ao.png"
+static std::string aov_path(const std::string& output, const char* name) {
+    std::filesystem::path path(output);
+    path.replace_filename(path.stem().string() + "_" + name + path.extension().string());
+    return path.string();
+}
+
 
 // Nokta dntrme fonksiyonu
 Vec3 transform_point(const Matrix4x4& mat, const Vec3& point) {
@@ -49,10 +60,89 @@ Vec3 transform_point(const Matrix4x4& mat, const Vec3& point) {
     return Vec3(x, y, z);
 }
 
+// Batch mode for machines without a display: the framebuffer is a plain
+// in-memory surface, SDL's video subsystem is never initialized.
+int run_headless(const RenderSettings& settings, const SceneDescription& scene) {
+    int imgFlags = IMG_INIT_PNG;
+    if (!(IMG_Init(imgFlags) & imgFlags)) {
+        std::cerr << "SDL_image could not initialize: " << IMG_GetError() << std::endl;
+        return 1;
+    }
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, settings.width, settings.height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (surface == nullptr) {
+        std::cerr << "Framebuffer allocation failed: " << SDL_GetError() << std::endl;
+        IMG_Quit();
+        return 1;
+    }
+    SDL_FillRect(surface, nullptr, 0);
+
+    CPUInfo::initialize();
+    if (!CPUInfo::has_feature("AVX2")) {
+        std::cerr << "Error: AVX2 support is required for rendering. Rendering aborted!" << std::endl;
+        SDL_FreeSurface(surface);
+        IMG_Quit();
+        return 1;
+    }
+
+    Renderer renderer(settings.width, settings.height, settings.samples_per_pixel, MAX_DEPTH);
+    renderer.set_scene(scene);
+    renderer.set_settings(settings);
+    bool rendered = renderer.render_image(surface, nullptr, settings.samples_per_pixel, settings.samples_per_pass);
+    bool saved = rendered && SaveSurface(surface, settings.output_path.c_str());
+    if (saved && settings.ao_samples > 0)
+        saved = renderer.save_ao_image(aov_path(settings.output_path, "ao"));
+
+    const RenderStats& stats = renderer.get_stats();
+    std::cout << "stats: scene=\"" << (settings.scene_path.empty() ? "<default>" : settings.scene_path) << "\""
+        << " resolution=" << settings.width << "x" << settings.height
+        << " spp=" << stats.samples_per_pixel
+        << " threads=" << stats.num_threads
+        << " objects=" << stats.object_count
+        << " lights=" << stats.light_count
+        << std::fixed << std::setprecision(3)
+        << " load_s=" << stats.scene_seconds
+        << " render_s=" << stats.render_seconds
+        << " denoise_s=" << stats.denoise_seconds
+        << " noise=" << stats.noise_estimate
+        << " total_s=" << stats.total_seconds
+        << " output=\"" << settings.output_path << "\""
+        << " status=" << (saved ? "ok" : "failed") << std::endl;
+
+    SDL_FreeSurface(surface);
+    IMG_Quit();
+    SDL_Quit();
+    return saved ? 0 : 1;
+}
+
 
 int main(int argc, char* argv[]) {
 
     setlocale(LC_ALL, "Turkish");
+
+    RenderSettings settings;
+    if (!parse_command_line(argc, argv, settings))
+        return 1;
+
+    // A JSON scene carries its own sampler/render settings; options given on
+    // the command line are applied on top of them.
+    SceneDescription scene;
+    if (SceneLoader::is_scene_file(settings.scene_path)) {
+        if (!SceneLoader::load(settings.scene_path, scene))
+            return 1;
+        RenderSettings merged = scene.settings;
+        merged.scene_path = settings.scene_path;
+        parse_command_line(argc, argv, merged);
+        settings = merged;
+    }
+    else {
+        scene = SceneLoader::default_scene(settings.scene_path);
+    }
+
+    if (!settings.benchmark.empty())
+        return Benchmark::run(settings);
+    if (settings.headless)
+        return run_headless(settings, scene);
    
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         std::cerr << "SDL_Init Error: " << SDL_GetError() << std::endl;
@@ -65,7 +155,7 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    SDL_Window* window = SDL_CreateWindow("Ray Tracing", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, image_width, image_height, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+    SDL_Window* window = SDL_CreateWindow("Ray Tracing", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, settings.width, settings.height, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
     if (window == nullptr) {
         std::cerr << "SDL_CreateWindow Error: " << SDL_GetError() << std::endl;
         SDL_Quit();
@@ -87,9 +177,12 @@ int main(int argc, char* argv[]) {
         std::cout << "Rendering started with AVX2 support..." << std::endl;
       
          // Render ilemi burada gerekleiyor
-        // Renderer::normalMapBuffer.reserve(image_width* image_height);
-        Renderer renderer(image_width, image_height, 1, 1);
-        renderer.render_image(surface, window, 1, 1);
+        Renderer renderer(settings.width, settings.height, settings.samples_per_pixel, MAX_DEPTH);
+        renderer.set_scene(scene);
+        renderer.set_settings(settings);
+        renderer.render_image(surface, window, settings.samples_per_pixel, settings.samples_per_pass);
+        if (settings.ao_samples > 0 && !renderer.save_ao_image(aov_path(settings.output_path, "ao")))
+            std::cerr << "Failed to save the AO image." << std::endl;
     }
     else {
         CPUInfo::print_cpu_info();
@@ -97,12 +190,10 @@ int main(int argc, char* argv[]) {
         // Render ilemi balatlmaz
     }
 
-    
-    Renderer::normalMapBuffer.clear();
 
     SDL_UpdateWindowSurface(window);
 
-    if (SaveSurface(surface, "output.png")) {
+    if (SaveSurface(surface, settings.output_path.c_str())) {
         std::cout << "Image saved successfully!" << std::endl;
     }
     else {
@@ -22,3 +22,27 @@ bool Material::volumetric_scatter(const Ray& r_in, const HitRecord& rec, Vec3& a
    
        return Vec3(0, 0, 0);
    }
+
+Vec3SIMD Material::eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi) const {
+    float cos_theta = Vec3SIMD(rec.normal).dot(wi);
+    if (cos_theta <= 0.0f)
+        return Vec3SIMD(0.0f, 0.0f, 0.0f);
+    return Vec3SIMD(get_albedo(rec.u, rec.v)) * static_cast<float>(cos_theta / M_PI);
+}
+
+float Material::pdf(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi) const {
+    float cos_theta = Vec3SIMD(rec.normal).dot(wi);
+    return cos_theta > 0.0f ? static_cast<float>(cos_theta / M_PI) : 0.0f;
+}
+
+Vec3SIMD Material::eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi, float& pdf) const {
+    pdf = this->pdf(rec, wo, wi);
+    return eval(rec, wo, wi);
+}
+
+bool Material::sample(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered, float& pdf) const {
+    if (!scatter(r_in, rec, attenuation, scattered))
+        return false;
+    pdf = is_specular() ? 0.0f : this->pdf(rec, -r_in.direction.normalize(), scattered.direction.normalize());
+    return true;
+}
@@ -0,0 +1,82 @@
+#include "MaterialTable.h"
+#include "Material.h"
+#include "PrincipledBSDF.h"
+#include "Metal.h"
+#include "Log.h"
+
+MaterialTable scene_materials;
+
+uint32_t MaterialTable::add(const std::shared_ptr<Material>& material) {
+    if (!material)
+        return none;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = ids.find(material.get());
+    if (found != ids.end())
+        return found->second;
+    const uint32_t id = static_cast<uint32_t>(pointers.size());
+    pointers.push_back(material.get());
+    owners.push_back(material);
+    ids.emplace(material.get(), id);
+    return id;
+}
+
+const std::shared_ptr<Material>& MaterialTable::shared(uint32_t id) const {
+    static const std::shared_ptr<Material> empty;
+    return id < owners.size() ? owners[id] : empty;
+}
+
+void MaterialTable::compile() {
+    std::lock_guard<std::mutex> lock(mutex);
+    records.assign(pointers.size(), CompiledMaterial());
+    int folded_fetches = 0;
+    size_t folded_materials = 0;
+    size_t masked_materials = 0;
+    for (size_t id = 0; id < pointers.size(); ++id) {
+        const int folded = pointers[id]->finalize();
+        folded_fetches += folded;
+        folded_materials += folded > 0;
+        const Material* material = pointers[id];
+        CompiledMaterial& record = records[id];
+        record.material = material;
+        record.type = material->type();
+        record.specular = material->is_specular();
+        record.normal_map = material->has_normal_map();
+        record.normal_strength = material->get_normal_strength();
+        record.scattering_factor = material->get_scattering_factor();
+        record.alpha_mask = material->alpha_mask();
+        masked_materials += record.alpha_mask != nullptr;
+
+        // Emission without a texture, or with a single-colour one, is a
+        // constant; only textured and volumetric emission go through emitted()
+        const MaterialProperty* emission = nullptr;
+        switch (record.type) {
+        case MaterialType::PrincipledBSDF:
+            emission = &static_cast<const PrincipledBSDF*>(material)->emissionProperty;
+            record.diffuse = static_cast<const PrincipledBSDF*>(material)->is_diffuse_dominated();
+            break;
+        case MaterialType::Metal:
+            emission = &static_cast<const Metal*>(material)->emissionProperty;
+            break;
+        case MaterialType::Emissive:
+            record.emission = Vec3SIMD(material->getEmission());
+            break;
+        case MaterialType::Volumetric:
+            record.uniform_emission = false;
+            break;
+        case MaterialType::Dielectric:
+            break;
+        }
+        if (emission) {
+            if (emission->is_constant)
+                record.emission = Vec3SIMD(emission->value);
+            else
+                record.uniform_emission = false;
+        }
+        record.emissive = !record.uniform_emission || record.emission.max_component() > 0.0f;
+    }
+    if (folded_fetches > 0)
+        LOG_INFO("Materials: " << folded_fetches << " texture fetches per hit folded into constants across "
+            << folded_materials << " of " << pointers.size() << " materials");
+    if (masked_materials > 0)
+        LOG_INFO("Materials: " << masked_materials << " alpha-tested during traversal");
+}
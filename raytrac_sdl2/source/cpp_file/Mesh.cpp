@@ -5,12 +5,13 @@
 #include <algorithm>
 #include "globals.h"
 #include "SmartUVProjection.h"
+#include "Log.h"
 
 
 void Mesh::applyUVProjection() {
     auto trianglePointers = getTriangles();
     if (trianglePointers.empty()) {
-        std::cerr << "Warning: No triangles in the mesh for UV projection." << std::endl;
+        LOG_WARN("No triangles in the mesh for UV projection");
         return;
     }
 
@@ -24,7 +25,7 @@ void Mesh::applyUVProjection() {
     smartUVProjection.apply(ProjectionType::PLANAR);
     // PrincipledBSDF materyallerine SmartUVProjection kullanmalarn syle
     for (auto& triangle : triangles) {
-        if (auto principledBSDF = std::dynamic_pointer_cast<PrincipledBSDF>(triangle.material)) {
+        if (auto principledBSDF = dynamic_cast<PrincipledBSDF*>(triangle.getMaterial())) {
             principledBSDF->useSmartUVProjection = true;
         }
     }
@@ -80,7 +81,8 @@ bool Mesh::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
         if (rayPolygonIntersect(r, face, t_min, closest_so_far, rec)) {
             hit_anything = true;
             closest_so_far = rec.t;
-            rec.material = material;
+            rec.material_id = material_id;
+            rec.light_index = -1;
 
             // Transform hit point and normal back to world space
             rec.point = transform.transform_point(rec.point);
@@ -252,7 +254,6 @@ void Mesh::triangulate() {
 
 std::vector<std::shared_ptr<Triangle>> Mesh::getTriangles() const {
     std::vector<std::shared_ptr<Triangle>> triangles;
-    std::cout << "Mesh::getTriangles() called. Faces count: " << faces.size() << std::endl;
 
     const Vec3 DEFAULT_NORMAL(0.0f, 1.0f, 0.0f);
     const Vec3 DEFAULT_VERTEX(0.0f, 0.0f, 0.0f);
@@ -279,7 +280,7 @@ std::vector<std::shared_ptr<Triangle>> Mesh::getTriangles() const {
 
     for (const auto& face : faces) {
         if (face.vertexIndices.size() < 3) {
-            std::cout << "Warning: Skipping face with less than 3 vertices." << std::endl;
+            LOG_WARN_LIMITED(8, "Skipping face with " << face.vertexIndices.size() << " vertices");
             continue;
         }
 
@@ -309,11 +310,11 @@ std::vector<std::shared_ptr<Triangle>> Mesh::getTriangles() const {
             ));
         }
         catch (const std::exception& e) {
-            std::cerr << "Error creating triangle: " << e.what() << std::endl;
+            LOG_ERROR_LIMITED(8, "Error creating triangle: " << e.what());
         }
     }
 
-    std::cout << "Mesh::getTriangles() returning " << triangles.size() << " triangles." << std::endl;
+    LOG_DEBUG("Mesh::getTriangles: " << faces.size() << " faces -> " << triangles.size() << " triangles");
     return triangles;
 }
 void Mesh::setPosition(const Vec3& pos) {
@@ -3,21 +3,24 @@
 #include "Texture.h"
 #include <algorithm>
 #include "HittableList.h"
+#include "ThreadLocalRNG.h"
 
 // Constructor with Vec3 albedo
 Metal::Metal(const Vec3& albedo, float roughness, float metallic, float fuzz, float clearcoat)
-    : albedoProperty(albedo), roughnessProperty(roughness), metallicProperty(metallic), fuzz(fuzz), clearcoat(clearcoat), clearcoatRoughness(0.1f), specularColor(Vec3(1.0f)), specularIntensity(1.0f), anisotropic(0.0f), anisotropicDirection(Vec3(1, 0, 0)) {}
+    : albedoProperty(albedo), roughnessProperty(roughness), metallicProperty(metallic), fuzz(fuzz), clearcoat(clearcoat), clearcoatRoughness(0.1f), specularColor(Vec3(1.0f)), metallicColor(Vec3(1.0f)), emissionProperty{ Vec3(0.0f, 0.0f, 0.0f), 0.0f }, specularIntensity(1.0f), anisotropic(0.0f), anisotropicDirection(Vec3(1, 0, 0)) {}
 
 // Constructor with Texture
 Metal::Metal(const std::shared_ptr<Texture>& albedoTexture, float roughness, float metallic, float fuzz, float clearcoat)
-    : albedoProperty(Vec3(1.0f), 1.0f, albedoTexture), roughnessProperty(roughness), metallicProperty(metallic), fuzz(fuzz), clearcoat(clearcoat), clearcoatRoughness(0.1f), specularColor(Vec3(1.0f)), specularIntensity(1.0f), anisotropic(0.0f), anisotropicDirection(Vec3(1, 0, 0)) {}
+    : albedoProperty(Vec3(1.0f), 1.0f, albedoTexture), roughnessProperty(roughness), metallicProperty(metallic), fuzz(fuzz), clearcoat(clearcoat), clearcoatRoughness(0.1f), specularColor(Vec3(1.0f)), metallicColor(Vec3(1.0f)), emissionProperty{ Vec3(0.0f, 0.0f, 0.0f), 0.0f }, specularIntensity(1.0f), anisotropic(0.0f), anisotropicDirection(Vec3(1, 0, 0)) {}
 
 MaterialType Metal::type() const {
     return MaterialType::Metal;
 }
 
 Vec3SIMD Metal::emitted(double u, double v, const Vec3SIMD& p) const {
-    return Vec3SIMD(0, 0, 0);
+    if (emissionProperty.is_constant)
+        return emissionProperty.value;
+    return getPropertyValue(emissionProperty, applyTextureTransform(u, v));
 }
 double Metal::getIndexOfRefraction() const {
     // Metaller iin genellikle kompleks krlma indeksi kullanlr,
@@ -25,10 +28,7 @@ double Metal::getIndexOfRefraction() const {
     return 0.0; // veya baka bir uygun deer
 }
 Vec3 Metal::getPropertyValue(const MaterialProperty& prop, const Vec2& uv) const {
-    if (prop.texture) {
-        return prop.texture->get_color(uv.u, uv.v) * prop.intensity;
-    }
-    return prop.color * prop.intensity;
+    return prop.evaluate(uv);
 }
 void Metal::setSpecular(const Vec3& specular, float intensity) {
     specularProperty = MaterialProperty(specular, intensity);
@@ -40,136 +40,64 @@ void Metal::setMetallic(float metallic, float intensity) {
 }
 // scatter function updated to use GGX BRDF
 Vec2 Metal::applyTextureTransform(double u, double v) const {
-    // Transform and wrap texture coordinates
-    u -= 0.5;
-    v -= 0.5;
-    u *= textureTransform.scale.u;
-    v *= textureTransform.scale.v;
-
-    double rotation_radians = textureTransform.rotation_degrees * M_PI / 180.0;
-    double cosTheta = std::cos(rotation_radians);
-    double sinTheta = std::sin(rotation_radians);
-    double newU = u * cosTheta - v * sinTheta;
-    double newV = u * sinTheta + v * cosTheta;
-    u = newU;
-    v = newV;
-
-    u += 0.5;
-    v += 0.5;
-    u += textureTransform.translation.u;
-    v += textureTransform.translation.v;
-
-    u = std::fmod(u * textureTransform.tilingFactor.u, 1.0);
-    v = std::fmod(v * textureTransform.tilingFactor.v, 1.0);
-
-    return applyWrapMode(u, v);
+    return uvTransform.apply(u, v);
+}
+void Metal::setTextureTransform(const TextureTransform& transform) {
+    textureTransform = transform;
+    uvTransform = transform.bake();
+}
+int Metal::finalize() {
+    uvTransform = textureTransform.bake();
+    int folded = 0;
+    for (MaterialProperty* prop : { &albedoProperty, &roughnessProperty, &metallicProperty, &emissionProperty })
+        folded += prop->bake();
+    return folded;
 }
 void Metal::set_normal_map(std::shared_ptr<Texture> normalMap, float normalStrength) {
     normalProperty.texture = normalMap;
     normalProperty.intensity = normalStrength;
 }
-Vec2 Metal::applyWrapMode(double u, double v) const {
-    switch (textureTransform.wrapMode) {
-    case WrapMode::Repeat:
-        u = std::fmod(u, 1.0);
-        v = std::fmod(v, 1.0);
-        if (u < 0) u += 1.0;
-        if (v < 0) v += 1.0;
-        break;
-    case WrapMode::Mirror:
-        u = std::fmod(u, 2.0);
-        v = std::fmod(v, 2.0);
-        if (u < 0) u += 2.0;
-        if (v < 0) v += 2.0;
-        if (u > 1.0) u = 2.0 - u;
-        if (v > 1.0) v = 2.0 - v;
-        break;
-    case WrapMode::Clamp:
-        u = std::max(0.0, std::min(1.0, u));
-        v = std::max(0.0, std::min(1.0, v));
-        break;
-    }
-    return Vec2(u, v);
-}
-
-float Metal::computeAmbientOcclusion(const Vec3& point, const Vec3& normal) const {
-    int numSamples = 16; // Number of samples for AO calculation
-    float aoRadius = 0.5f; // Radius of the AO sampling sphere
-    float occlusion = 0.0f;
-    HittableList world;
-    for (int i = 0; i < numSamples; ++i) {
-        // Generate a random direction in the hemisphere around the normal
-        Vec3 randomDir = Vec3SIMD::random_in_hemisphere(normal);
-
-        // Create a small offset to avoid self-intersection
-        Vec3 samplePoint = point + normal * 0.001f;
-
-        // Cast a ray from the sample point in the random direction
-        Ray aoRay(samplePoint, randomDir);
-
-        // Check if the ray intersects any geometry
-        HitRecord tempRec;
-        if (world.hit(aoRay, 0.001f, aoRadius, tempRec)) {
-            occlusion += 1.0f;
-        }
-    }
 
-    // Compute the final ambient occlusion factor
-    float ao = 1.0f - (occlusion / float(numSamples));
-    return ao;
-}
-
-
-bool Metal::scatter(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered) const {
-    Vec3SIMD N = rec.normal;
-    Vec3SIMD V = -r_in.direction.normalize();
-    Vec2 transformedUV = applyTextureTransform(rec.u, rec.v);
+MicrofacetLobes Metal::lobes_at(const HitRecord& rec) const {
+    MicrofacetLobes lobes;
     Vec3SIMD baseColor = getPropertyValue(albedoProperty, Vec2(rec.u, rec.v));
-    float metallicValue = getPropertyValue(metallicProperty, Vec2(rec.u, rec.v)).x;
-    float roughnessValue = max(getPropertyValue(roughnessProperty, Vec2(rec.u, rec.v)).x, 0.01f);
-
+    lobes.albedo = baseColor;
+    lobes.metallic = std::clamp(static_cast<float>(getPropertyValue(metallicProperty, Vec2(rec.u, rec.v)).x), 0.0f, 1.0f);
+    lobes.roughness = max(getPropertyValue(roughnessProperty, Vec2(rec.u, rec.v)).x, 0.01f);
     // Use metallicColor to influence F0
-    Vec3SIMD F0 = Vec3SIMD::lerp(Vec3(0.04f), baseColor * metallicColor, metallicValue);
-
-    Vec3SIMD R = Vec3SIMD::reflect(-V, N);
-    Vec3 scatteredDirection = R + (roughnessValue + 0.001f) * Vec3SIMD::random_in_unit_sphere();
-    scattered = Ray(rec.point, scatteredDirection.normalize());
-    Vec3SIMD L = scattered.direction;
-    Vec3SIMD H = (V + L).normalize();
-
-    double NDF = DistributionGGX(N, H, roughnessValue);
-    double G = GeometrySmith(N, V, L, roughnessValue);
-    Vec3 F = fresnelSchlick(max(Vec3::dot(H, V), 0.0), F0);
-
-    Vec3 numerator = NDF * G * F;
-    double denominator = 4.0 * max(Vec3::dot(N, V), 0.0) * max(Vec3::dot(N, L), 0.0) + 0.000001;
-    Vec3 specular = numerator / denominator*2;
-
-    Vec3SIMD kS = F;
-    Vec3SIMD kD = Vec3(1.0f - metallicValue) * (Vec3(1.0) - F);
-
-    double NdotL = max(Vec3::dot(N, L), 0.0);
-
-    // Incorporate metallicColor into both diffuse and specular components
-    Vec3SIMD diffuse = kD * baseColor / M_PI;
-    Vec3SIMD spec = kS * specular * baseColor * metallicColor;
-
-    // Blend between diffuse and specular based on metallicValue
-    attenuation = Vec3SIMD::lerp(diffuse, spec, metallicValue) * NdotL;
+    lobes.f0 = Vec3SIMD::lerp(Vec3SIMD(0.04f, 0.04f, 0.04f), baseColor * Vec3SIMD(metallicColor), lobes.metallic);
+    lobes.clearcoat = clearcoat;
+    lobes.clearcoat_roughness = clearcoatRoughness;
+    return lobes;
+}
 
-    Vec3SIMD emissionValue = getPropertyValue(emissionProperty, transformedUV);
-    attenuation += emissionValue;
+Vec3SIMD Metal::eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi) const {
+    return lobes_at(rec).eval(rec.normal, wo, wi);
+}
 
-    double ao = computeAmbientOcclusion(rec.point, N);
-    attenuation *= ao;
+float Metal::pdf(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi) const {
+    return lobes_at(rec).pdf(rec.normal, wo, wi);
+}
 
-    if (clearcoat > 0.0) {
-        Vec3SIMD clearcoatReflection = computeClearcoat(R, N);
-        double clearcoatFactor = clearcoat * (1.0 - metallicValue);
-        attenuation = Vec3SIMD::lerp(attenuation, clearcoatReflection * baseColor * metallicColor, clearcoatFactor);
-    }
+Vec3SIMD Metal::eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi, float& pdf) const {
+    return lobes_at(rec).eval(rec.normal, wo, wi, pdf);
+}
 
-    //attenuation = attenuation.clamp(0.0, 1.0);
+bool Metal::scatter(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered) const {
+    float sample_pdf;
+    return sample(r_in, rec, attenuation, scattered, sample_pdf);
+}
+
+bool Metal::sample(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered, float& sample_pdf) const {
+    const MicrofacetLobes lobes = lobes_at(rec);
+    ThreadLocalRNG& rng = ThreadLocalRNG::instance();
+    const float u0 = rng.get();
+    const float u1 = rng.get();
+    const float u2 = rng.get();
+    Vec3SIMD L;
+    if (!lobes.sample(rec.normal, -r_in.direction.normalize(), u0, u1, u2, L, attenuation, sample_pdf))
+        return false;
+    scattered = Ray(rec.point, L);
     return true;
 }
 
@@ -0,0 +1,152 @@
+#include "Microfacet.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr float kPi = static_cast<float>(M_PI);
+
+    void orthonormal_basis(const Vec3SIMD& n, Vec3SIMD& t, Vec3SIMD& b) {
+        Vec3SIMD up = std::abs(n.z()) < 0.999f ? Vec3SIMD(0.0f, 0.0f, 1.0f) : Vec3SIMD(1.0f, 0.0f, 0.0f);
+        t = up.cross(n).normalize();
+        b = n.cross(t);
+    }
+}
+
+float MicrofacetLobes::ggx_distribution(float n_dot_h, float roughness) {
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float d = n_dot_h * n_dot_h * (a2 - 1.0f) + 1.0f;
+    return a2 / (kPi * d * d + 1e-7f);
+}
+
+float MicrofacetLobes::smith_geometry(float n_dot_v, float n_dot_l, float roughness) {
+    // Schlick-GGX with k = (r + 1)^2 / 8, as the materials used before
+    float r = roughness + 1.0f;
+    float k = (r * r) / 8.0f;
+    float g_v = n_dot_v / (n_dot_v * (1.0f - k) + k);
+    float g_l = n_dot_l / (n_dot_l * (1.0f - k) + k);
+    return g_v * g_l;
+}
+
+Vec3SIMD MicrofacetLobes::fresnel_schlick(float cos_theta, const Vec3SIMD& f0) {
+    float m = std::clamp(1.0f - cos_theta, 0.0f, 1.0f);
+    float m5 = (m * m) * (m * m) * m;
+    return f0 + (Vec3SIMD(1.0f, 1.0f, 1.0f) - f0) * m5;
+}
+
+Vec3SIMD MicrofacetLobes::sample_ggx_half(float u1, float u2, float roughness, const Vec3SIMD& n) {
+    // Samples D(h) * cos(n, h)
+    float a = roughness * roughness;
+    float phi = 2.0f * kPi * u1;
+    float cos_theta = std::sqrt((1.0f - u2) / (1.0f + (a * a - 1.0f) * u2));
+    float sin_theta = std::sqrt(std::max(0.0f, 1.0f - cos_theta * cos_theta));
+    Vec3SIMD t, b;
+    orthonormal_basis(n, t, b);
+    return (t * (sin_theta * std::cos(phi)) + b * (sin_theta * std::sin(phi)) + n * cos_theta).normalize();
+}
+
+Vec3SIMD MicrofacetLobes::sample_cosine(float u1, float u2, const Vec3SIMD& n) {
+    float r = std::sqrt(u1);
+    float phi = 2.0f * kPi * u2;
+    Vec3SIMD t, b;
+    orthonormal_basis(n, t, b);
+    return (t * (r * std::cos(phi)) + b * (r * std::sin(phi)) + n * std::sqrt(std::max(0.0f, 1.0f - u1))).normalize();
+}
+
+void MicrofacetLobes::lobe_probabilities(float& p_diffuse, float& p_specular, float& p_clearcoat) const {
+    float w_diffuse = 0.5f * (1.0f - metallic);
+    float w_specular = 1.0f - w_diffuse;
+    float w_clearcoat = 0.25f * std::clamp(clearcoat, 0.0f, 1.0f);
+    float total = w_diffuse + w_specular + w_clearcoat;
+    p_diffuse = w_diffuse / total;
+    p_specular = w_specular / total;
+    p_clearcoat = w_clearcoat / total;
+}
+
+Vec3SIMD MicrofacetLobes::eval(const Vec3SIMD& n, const Vec3SIMD& wo, const Vec3SIMD& wi) const {
+    float unused_pdf;
+    return eval(n, wo, wi, unused_pdf);
+}
+
+Vec3SIMD MicrofacetLobes::eval(const Vec3SIMD& n, const Vec3SIMD& wo, const Vec3SIMD& wi, float& pdf) const {
+    pdf = 0.0f;
+    const float n_dot_l = n.dot(wi);
+    const float n_dot_v = n.dot(wo);
+    if (n_dot_l <= 0.0f || n_dot_v <= 0.0f)
+        return Vec3SIMD(0.0f, 0.0f, 0.0f);
+
+    float p_diffuse, p_specular, p_clearcoat;
+    lobe_probabilities(p_diffuse, p_specular, p_clearcoat);
+
+    const Vec3SIMD h = (wo + wi).normalize();
+    const float n_dot_h = std::max(n.dot(h), 0.0f);
+    const float v_dot_h = std::max(wo.dot(h), 0.0f);
+    const float r = std::max(roughness, min_roughness);
+    // Half-vector density to solid angle: D * cos(n, h) / (4 * (wo . h))
+    const float half_to_solid = n_dot_h / (4.0f * std::max(v_dot_h, 1e-6f));
+    const float inv_nv_nl = 1.0f / (4.0f * n_dot_v * n_dot_l);
+
+    const Vec3SIMD F = fresnel_schlick(v_dot_h, f0);
+    const float D = ggx_distribution(n_dot_h, r);
+    const float G = smith_geometry(n_dot_v, n_dot_l, r);
+    Vec3SIMD specular = F * (D * G * inv_nv_nl);
+    Vec3SIMD diffuse = (Vec3SIMD(1.0f, 1.0f, 1.0f) - F) * albedo * ((1.0f - metallic) / kPi);
+    Vec3SIMD f = diffuse + specular;
+    pdf = p_diffuse * n_dot_l / kPi + p_specular * D * half_to_solid;
+
+    if (clearcoat > 0.0f) {
+        // Clear dielectric layer on top; the base only receives what it transmits
+        const float rc = std::max(clearcoat_roughness, min_roughness);
+        const float Dc = ggx_distribution(n_dot_h, rc);
+        float Fc = fresnel_schlick(v_dot_h, Vec3SIMD(0.04f, 0.04f, 0.04f)).x() * clearcoat;
+        float coat = Fc * Dc * smith_geometry(n_dot_v, n_dot_l, rc) * inv_nv_nl;
+        f = f * (1.0f - Fc) + Vec3SIMD(coat, coat, coat);
+        pdf += p_clearcoat * Dc * half_to_solid;
+    }
+    return f * n_dot_l;
+}
+
+float MicrofacetLobes::pdf(const Vec3SIMD& n, const Vec3SIMD& wo, const Vec3SIMD& wi) const {
+    const float n_dot_l = n.dot(wi);
+    if (n_dot_l <= 0.0f || n.dot(wo) <= 0.0f)
+        return 0.0f;
+
+    float p_diffuse, p_specular, p_clearcoat;
+    lobe_probabilities(p_diffuse, p_specular, p_clearcoat);
+
+    const Vec3SIMD h = (wo + wi).normalize();
+    const float n_dot_h = std::max(n.dot(h), 0.0f);
+    const float v_dot_h = std::max(wo.dot(h), 1e-6f);
+    // Half-vector density to solid angle: D * cos(n, h) / (4 * (wo . h))
+    float pdf = p_diffuse * n_dot_l / kPi;
+    pdf += p_specular * ggx_distribution(n_dot_h, std::max(roughness, min_roughness)) * n_dot_h / (4.0f * v_dot_h);
+    if (p_clearcoat > 0.0f)
+        pdf += p_clearcoat * ggx_distribution(n_dot_h, std::max(clearcoat_roughness, min_roughness)) * n_dot_h / (4.0f * v_dot_h);
+    return pdf;
+}
+
+bool MicrofacetLobes::sample(const Vec3SIMD& n, const Vec3SIMD& wo, float u0, float u1, float u2, Vec3SIMD& wi) const {
+    float p_diffuse, p_specular, p_clearcoat;
+    lobe_probabilities(p_diffuse, p_specular, p_clearcoat);
+
+    if (u0 < p_diffuse) {
+        wi = sample_cosine(u1, u2, n);
+    }
+    else {
+        float r = u0 < p_diffuse + p_specular ? roughness : clearcoat_roughness;
+        Vec3SIMD h = sample_ggx_half(u1, u2, std::max(r, min_roughness), n);
+        wi = (h * (2.0f * wo.dot(h)) - wo).normalize();
+    }
+    return n.dot(wi) > 0.0f;
+}
+
+bool MicrofacetLobes::sample(const Vec3SIMD& n, const Vec3SIMD& wo, float u0, float u1, float u2,
+    Vec3SIMD& wi, Vec3SIMD& weight, float& pdf) const {
+    if (!sample(n, wo, u0, u1, u2, wi))
+        return false;
+    Vec3SIMD f = eval(n, wo, wi, pdf);
+    if (pdf <= 0.0f)
+        return false;
+    weight = f / pdf;
+    return true;
+}
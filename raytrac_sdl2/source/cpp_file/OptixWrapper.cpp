@@ -250,10 +250,10 @@ OptixHitResult OptixWrapper::performOptixIntersectionTest(const float3& origin,
         rec.t = result.t;
         rec.point = float3ToVec3(result.hitPoint);
         rec.normal = float3ToVec3(result.normal);
-        rec.material = result.material ; // Materyal kontrol
+        rec.material_id = result.material_id; // Materyal kontrol
 
         // Sonular OptiXHitResult'e kaydet
-        result.hasHit = rec.material != nullptr; // rnein, hasHit'e material var m kontrol
+        result.hasHit = rec.material_id != MaterialTable::none; // rnein, hasHit'e material var m kontrol
         result.t = rec.t;
         result.hitObjectID = result.hitObjectID; // ID'yi gncelle
     }
@@ -272,7 +272,7 @@ bool OptixWrapper::hit_with_optix(const Ray& r, double t_min, double t_max, HitR
         rec.point = Vec3(result.hitPoint.x, result.hitPoint.y, result.hitPoint.z);
         rec.normal = Vec3(result.normal.x, result.normal.y, result.normal.z);
         // Materyali ayarla
-        rec.material = result.material;
+        rec.material_id = result.material_id;
         return true;
     }
 
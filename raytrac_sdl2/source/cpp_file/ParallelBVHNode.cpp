@@ -1,4 +1,5 @@
 #include "ParallelBVHNode.h"
+#include "Log.h"
 
 
 std::atomic<int> ParallelBVHNode::active_threads(0);
@@ -24,7 +25,7 @@ ParallelBVHNode::ParallelBVHNode(const std::vector<std::shared_ptr<Hittable>>& s
     if (object_span <= 2) {
         // Eer object_span 0 veya negatifse, eriim yapmadan nce kontrol ediyoruz
         if (object_span <= 0) {
-            std::cerr << "Hata: objects dizisinde hi eleman yok." << std::endl;
+            LOG_ERROR("Hata: objects dizisinde hi eleman yok.");
             return;  // Eriim yapmadan k
         }
 
@@ -72,7 +73,7 @@ ParallelBVHNode::ParallelBVHNode(const std::vector<std::shared_ptr<Hittable>>& s
 
     AABB box_left, box_right;
     if (!left->bounding_box(time0, time1, box_left) || !right->bounding_box(time0, time1, box_right))
-        std::cerr << "No bounding box in BVHNode constructor.\n";
+        LOG_WARN_LIMITED(8, "No bounding box in BVHNode constructor");
 
     box = surrounding_box(box_left, box_right);
 }
@@ -112,7 +113,37 @@ bool ParallelBVHNode::hit(const Ray& r, double t_min, double t_max, HitRecord& r
     bool hit_right = right->hit(r, t_min, hit_left ? rec.t : t_max, rec);
 
     return hit_left || hit_right;
-}bool ParallelBVHNode::bounding_box(double time0, double time1, AABB& output_box) const {
+}
+
+bool ParallelBVHNode::occluded(const Ray& r, double t_min, double t_max) const {
+    if (use_optix && optix_wrapper) {
+        HitRecord rec;
+        return hit(r, t_min, t_max, rec);
+    }
+    if (!box.hit(r, t_min, t_max))
+        return false;
+    return left->occluded(r, t_min, t_max) || right->occluded(r, t_min, t_max);
+}
+
+uint32_t ParallelBVHNode::occluded_packet(const Ray* rays, const float* t_max, uint32_t active, double t_min) const {
+    if (use_optix && optix_wrapper)
+        return Hittable::occluded_packet(rays, t_max, active, t_min);
+
+    uint32_t live = 0;
+    for (uint32_t bits = active; bits; bits &= bits - 1) {
+        const int i = std::countr_zero(bits);
+        if (box.hit(rays[i], t_min, t_max[i]))
+            live |= 1u << i;
+    }
+    if (!live)
+        return 0;
+
+    uint32_t blocked = left->occluded_packet(rays, t_max, live, t_min);
+    if (live & ~blocked)
+        blocked |= right->occluded_packet(rays, t_max, live & ~blocked, t_min);
+    return blocked;
+}
+bool ParallelBVHNode::bounding_box(double time0, double time1, AABB& output_box) const {
     output_box = box;
     return true;
 }
@@ -123,14 +154,14 @@ bool ParallelBVHNode::box_compare(const std::shared_ptr<Hittable> a, const std::
     AABB box_b;
 
     if (!a->bounding_box(0, 0, box_a) || !b->bounding_box(0, 0, box_b))
-        std::cerr << "No bounding box in BVHNode constructor.\n";
+        LOG_WARN_LIMITED(8, "No bounding box in box_compare");
 
     switch (axis) {
     case 0: return box_a.min.x() < box_b.min.x();
     case 1: return box_a.min.y() < box_b.min.y();
     case 2: return box_a.min.z() < box_b.min.z();
     default:
-        std::cerr << "Invalid axis in box_compare\n";
+        LOG_ERROR_LIMITED(8, "Invalid axis " << axis << " in box_compare");
         return false;
     }
 }
@@ -0,0 +1,120 @@
+#include "RadianceCache.h"
+#include <algorithm>
+#include <cmath>
+
+void RadianceCache::clear() {
+    entries.reset();
+    capacity_mask = 0;
+    used.store(0, std::memory_order_relaxed);
+}
+
+void RadianceCache::build(const AABB& scene_box, int resolution, size_t capacity) {
+    clear();
+    // Power of two so the hash can be masked
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+    entries.reset(new Entry[size]);
+    for (size_t i = 0; i < size; ++i) {
+        entries[i].key.store(0, std::memory_order_relaxed);
+        entries[i].r.store(0.0f, std::memory_order_relaxed);
+        entries[i].g.store(0.0f, std::memory_order_relaxed);
+        entries[i].b.store(0.0f, std::memory_order_relaxed);
+        entries[i].count.store(0, std::memory_order_relaxed);
+    }
+    capacity_mask = size - 1;
+
+    Vec3SIMD extent = scene_box.max - scene_box.min;
+    float longest = std::max({ extent.x(), extent.y(), extent.z(), 1e-3f });
+    origin = scene_box.min;
+    inv_cell = std::max(resolution, 1) / longest;
+}
+
+uint64_t RadianceCache::mix(uint64_t key) {
+    // splitmix64 finalizer
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return key;
+}
+
+uint64_t RadianceCache::key_of(const Vec3SIMD& point, const Vec3SIMD& normal) const {
+    // 18 bits per axis; points outside the scene box wrap, which only
+    // shares a cell with a far away one
+    const Vec3SIMD p = (point - origin) * inv_cell;
+    const uint64_t x = static_cast<uint64_t>(static_cast<int64_t>(std::floor(p.x()))) & 0x3ffff;
+    const uint64_t y = static_cast<uint64_t>(static_cast<int64_t>(std::floor(p.y()))) & 0x3ffff;
+    const uint64_t z = static_cast<uint64_t>(static_cast<int64_t>(std::floor(p.z()))) & 0x3ffff;
+
+    // Dominant axis and sign of the normal: opposite sides of a wall and
+    // floor/wall corners land in different entries
+    const float ax = std::abs(normal.x()), ay = std::abs(normal.y()), az = std::abs(normal.z());
+    uint64_t side;
+    if (ax >= ay && ax >= az)
+        side = normal.x() >= 0.0f ? 0 : 1;
+    else if (ay >= az)
+        side = normal.y() >= 0.0f ? 2 : 3;
+    else
+        side = normal.z() >= 0.0f ? 4 : 5;
+
+    return ((x | (y << 18) | (z << 36)) << 3 | side) + 1;
+}
+
+uint32_t RadianceCache::slot(const Vec3SIMD& point, const Vec3SIMD& normal) {
+    if (!valid())
+        return npos;
+    const uint64_t key = key_of(point, normal);
+    size_t index = mix(key) & capacity_mask;
+    for (int probe = 0; probe < max_probes; ++probe, index = (index + 1) & capacity_mask) {
+        uint64_t current = entries[index].key.load(std::memory_order_acquire);
+        if (current == key)
+            return static_cast<uint32_t>(index);
+        if (current == 0) {
+            uint64_t expected = 0;
+            if (entries[index].key.compare_exchange_strong(expected, key, std::memory_order_acq_rel)) {
+                used.fetch_add(1, std::memory_order_relaxed);
+                return static_cast<uint32_t>(index);
+            }
+            if (expected == key)
+                return static_cast<uint32_t>(index);
+        }
+    }
+    return npos;
+}
+
+void RadianceCache::add(uint32_t slot, const Vec3SIMD& radiance) {
+    if (slot == npos)
+        return;
+    Entry& entry = entries[slot];
+    entry.r.fetch_add(radiance.x(), std::memory_order_relaxed);
+    entry.g.fetch_add(radiance.y(), std::memory_order_relaxed);
+    entry.b.fetch_add(radiance.z(), std::memory_order_relaxed);
+    entry.count.fetch_add(1, std::memory_order_release);
+}
+
+bool RadianceCache::lookup(const Vec3SIMD& point, const Vec3SIMD& normal, Vec3SIMD& radiance) const {
+    if (!valid())
+        return false;
+    const uint64_t key = key_of(point, normal);
+    size_t index = mix(key) & capacity_mask;
+    for (int probe = 0; probe < max_probes; ++probe, index = (index + 1) & capacity_mask) {
+        const Entry& entry = entries[index];
+        uint64_t current = entry.key.load(std::memory_order_acquire);
+        if (current == 0)
+            return false;
+        if (current != key)
+            continue;
+        uint32_t count = entry.count.load(std::memory_order_acquire);
+        if (count < min_samples)
+            return false;
+        // The three sums may be a sample or two ahead of count; harmless for an average
+        float inv = 1.0f / count;
+        radiance = Vec3SIMD(entry.r.load(std::memory_order_relaxed) * inv,
+            entry.g.load(std::memory_order_relaxed) * inv,
+            entry.b.load(std::memory_order_relaxed) * inv);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,186 @@
+#include "RenderSettings.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <charconv>
+
+static bool parse_int(const char* text, int& value) {
+    char* end = nullptr;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed <= 0)
+        return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+// Like parse_int, but 0 is allowed
+static bool parse_count(const char* text, int& value) {
+    char* end = nullptr;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < 0)
+        return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+// Always '.' as the decimal separator: main() switches the C locale to
+// Turkish, where strtof would stop at the '.' of "0.25"
+static bool parse_float(const char* text, float& value) {
+    const char* end = text + std::strlen(text);
+    float parsed = 0.0f;
+    const auto result = std::from_chars(text, end, parsed);
+    if (result.ec != std::errc() || result.ptr != end || parsed < 0.0f)
+        return false;
+    value = parsed;
+    return true;
+}
+
+static bool parse_resolution(const char* text, int& width, int& height) {
+    const char* x = std::strchr(text, 'x');
+    if (!x)
+        return false;
+    std::string w(text, x - text);
+    return parse_int(w.c_str(), width) && parse_int(x + 1, height);
+}
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+        << "  --headless              render without a window and exit\n"
+        << "  --scene <file>          JSON scene description or model file\n"
+        << "  --resolution <WxH>      output resolution (e.g. 1920x1080)\n"
+        << "  --width <n>             output width\n"
+        << "  --height <n>            output height\n"
+        << "  --spp <n>               samples per pixel\n"
+        << "  --samples-per-pass <n>  samples per progressive pass\n"
+        << "  --max-depth <n>         hard limit on path length (default 32)\n"
+        << "  --roulette-depth <n>    bounces before Russian roulette may end a path (default 3)\n"
+        << "  --roulette-threshold <f> throughput below which paths face roulette, 0 = off (default 1)\n"
+        << "  --output <file>         output PNG path (default output.png)\n"
+        << "  --threads <n>           worker threads (default: all cores)\n"
+        << "  --no-denoise            skip OIDN denoising\n"
+        << "  --no-sun-cache          trace every sun shadow ray through the BVH\n"
+        << "  --radiance-cache        reuse cached diffuse indirect light (faster, biased previews)\n"
+        << "  --wavefront             trace paths breadth first, shading hits sorted by material\n"
+        << "  --ao-samples <n>        write an ambient occlusion AOV (<output>_ao.png) with n rays per hit\n"
+        << "  --ao-radius <f>         ambient occlusion distance (default 1)\n"
+        << "  --area-samples <n>      stratified shadow samples per area-light hit (default 4)\n"
+        << "  --denoise-budget <f>    max share of render time for preview denoises (default 0.25)\n"
+        << "  --time-budget <s>       render until <s> seconds are spent, final denoise included\n"
+        << "  --noise-target <f>      render until the relative noise estimate drops below <f>\n"
+        << "  --max-spp <n>           sample cap for --time-budget / --noise-target (default 65536)\n"
+        << "  --bench <name>          run a micro benchmark (direct-lighting, sun-cache, scatter, wavefront, roulette) and exit\n"
+        << "  --help                  show this message" << std::endl;
+}
+
+bool parse_command_line(int argc, char* argv[], RenderSettings& settings) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        // Every option except the flags below takes one value.
+        if (arg == "--headless") {
+            settings.headless = true;
+            continue;
+        }
+        if (arg == "--no-denoise") {
+            settings.denoise = false;
+            continue;
+        }
+        if (arg == "--no-sun-cache") {
+            settings.sun_cache = false;
+            continue;
+        }
+        if (arg == "--radiance-cache") {
+            settings.radiance_cache = true;
+            continue;
+        }
+        if (arg == "--wavefront") {
+            settings.wavefront = true;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return false;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for option " << arg << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+        bool ok = true;
+        int n = 0;
+
+        if (arg == "--scene") {
+            settings.scene_path = value;
+        }
+        else if (arg == "--output") {
+            settings.output_path = value;
+        }
+        else if (arg == "--resolution") {
+            ok = parse_resolution(value, settings.width, settings.height);
+        }
+        else if (arg == "--width") {
+            ok = parse_int(value, settings.width);
+        }
+        else if (arg == "--height") {
+            ok = parse_int(value, settings.height);
+        }
+        else if (arg == "--spp") {
+            ok = parse_int(value, settings.samples_per_pixel);
+        }
+        else if (arg == "--samples-per-pass") {
+            ok = parse_int(value, settings.samples_per_pass);
+        }
+        else if (arg == "--ao-samples") {
+            ok = parse_count(value, settings.ao_samples);
+        }
+        else if (arg == "--ao-radius") {
+            ok = parse_float(value, settings.ao_radius) && settings.ao_radius > 0.0f;
+        }
+        else if (arg == "--area-samples") {
+            ok = parse_int(value, settings.area_light_samples);
+        }
+        else if (arg == "--max-depth") {
+            ok = parse_int(value, settings.max_depth);
+        }
+        else if (arg == "--roulette-depth") {
+            ok = parse_count(value, settings.roulette_depth);
+        }
+        else if (arg == "--roulette-threshold") {
+            ok = parse_float(value, settings.roulette_threshold);
+        }
+        else if (arg == "--denoise-budget") {
+            ok = parse_float(value, settings.denoise_budget);
+        }
+        else if (arg == "--time-budget") {
+            ok = parse_float(value, settings.time_budget);
+        }
+        else if (arg == "--noise-target") {
+            ok = parse_float(value, settings.noise_target);
+        }
+        else if (arg == "--max-spp") {
+            ok = parse_int(value, settings.max_samples_per_pixel);
+        }
+        else if (arg == "--bench") {
+            settings.benchmark = value;
+        }
+        else if (arg == "--threads") {
+            ok = parse_int(value, n);
+            settings.num_threads = static_cast<unsigned int>(n);
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            print_usage(argv[0]);
+            return false;
+        }
+
+        if (!ok) {
+            std::cerr << "Invalid value for " << arg << ": " << value << std::endl;
+            return false;
+        }
+    }
+
+    const bool adaptive = settings.time_budget > 0.0f || settings.noise_target > 0.0f;
+    const int sample_cap = adaptive ? settings.max_samples_per_pixel : settings.samples_per_pixel;
+    if (settings.samples_per_pass > sample_cap)
+        settings.samples_per_pass = sample_cap;
+    return true;
+}
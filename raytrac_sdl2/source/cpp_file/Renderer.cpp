@@ -3,117 +3,139 @@
 #include "SmartUVProjection.h"
 #include "SpotLight.h"
 #include "AssimpLoader.h"
+#include "Log.h"
+#include "MaterialDispatch.h"
+#include "WavefrontIntegrator.h"
 #include <filesystem>
 
-bool Renderer::isCudaAvailable() {
-    try {
-        oidn::DeviceRef testDevice = oidn::newDevice(oidn::DeviceType::CUDA);
-        testDevice.commit();
-        return true; // CUDA destekleniyor
-    }
-    catch (const std::exception& e) {
-        return false; // CUDA desteklenmiyor
-    }
+Renderer::Renderer( int image_width, int image_height, int samples_per_pixel, int max_depth)
+    : image_width(image_width), image_height(image_height),  aspect_ratio(static_cast<double>(image_width) / image_height), halton_cache(MAX_DIMENSIONS, std::vector<float>(MAX_SAMPLES)) 
+    {
+    initialize_halton_cache();
 }
 
-void Renderer::applyOIDNDenoising(SDL_Surface* surface, int numThreads = 0, bool denoise = true, float blend = 0.8f) {
-    Uint32* pixels = static_cast<Uint32*>(surface->pixels);
-    int width = surface->w;
-    int height = surface->h;
-
-    std::vector<float> colorBuffer(width * height * 3);
-    // std::vector<float> normalBuffer(width * height * 3);
-
-    for (int i = 0; i < width * height; ++i) {
-        Uint8 r, g, b;
-        SDL_GetRGB(pixels[i], surface->format, &r, &g, &b);
-        colorBuffer[i * 3] = r / 255.0f;
-        colorBuffer[i * 3 + 1] = g / 255.0f;
-        colorBuffer[i * 3 + 2] = b / 255.0f;
-        // Normal map bilgisini normalBuffer'a ekleyin ve 0-1 aralna normalize edin
-      // nce normal vektrn normalize et
-        //Vec3 normal = Renderer::normalMapBuffer[i].normalize();
-        //float x = (normal.x + 1.0f) * 0.5f;
-        //float y = (normal.y + 1.0f) * 0.5f;
-        //float z = (normal.z + 1.0f) * 0.5f;
-        //// Normal verilerini normalBuffer'a aktar
-        //normalBuffer[i * 3] = x;
-        //normalBuffer[i * 3 + 1] = y;
-        //normalBuffer[i * 3 + 2] = z;
-
-    }
-
-    oidn::DeviceRef device;
-    if (isCudaAvailable()) {
-      //  std::cout << "CUDA destekleniyor, CUDA cihaz kullanlyor." << std::endl;
-        device = oidn::newDevice(oidn::DeviceType::CUDA);
-    }
-    else {
-        std::cout << "CUDA desteklenmiyor, CPU cihaz kullanlyor." << std::endl;
-        device = oidn::newDevice(oidn::DeviceType::CPU);
-    }
-    device.set("numThreads", numThreads);
-    device.commit();
-
-    oidn::BufferRef colorOIDNBuffer = device.newBuffer(colorBuffer.size() * sizeof(float));
-    //  oidn::BufferRef normalOIDNBuffer = device.newBuffer(normalBuffer.size() * sizeof(float));
-    oidn::BufferRef outputOIDNBuffer = device.newBuffer(colorBuffer.size() * sizeof(float));
-    std::memcpy(colorOIDNBuffer.getData(), colorBuffer.data(), colorBuffer.size() * sizeof(float));
-    // std::memcpy(normalOIDNBuffer.getData(), normalBuffer.data(), normalBuffer.size() * sizeof(float));
-
-    oidn::Quality::High;
-   
-
-    oidn::FilterRef filter = device.newFilter("RT");   
-    filter.setImage("color", colorOIDNBuffer, oidn::Format::Float3, width, height);
-    filter.setImage("output", outputOIDNBuffer, oidn::Format::Float3, width, height);
-
-    filter.set("hdr", false);
-    filter.set("srgb", true); // auxiliary images will be prefiltered
-    filter.set("denoise", denoise);
+Renderer::~Renderer() {}
 
-    filter.commit();
-    // Denoising sresini lmek iin balang zamann al
-    auto start = std::chrono::high_resolution_clock::now();
-    // normalfilter.execute();
-    filter.execute();
+void Renderer::initializeBuffers(int width, int height) {
+    const size_t size = static_cast<size_t>(width) * height * 3;
+    accumulation_buffer.assign(size, 0.0f);
+    albedo_buffer.assign(size, 0.0f);
+    normal_buffer.assign(size, 0.0f);
+    ao_buffer.assign(settings.ao_samples > 0 ? static_cast<size_t>(width) * height : 0, 0.0f);
+    luminance_sq_buffer.assign(static_cast<size_t>(width) * height, 0.0f);
+    denoise_input.assign(size, 0.0f);
+    denoise_albedo.assign(size, 0.0f);
+    denoise_normal.assign(size, 0.0f);
+}
 
-    // Denoising sresini lmek iin biti zamann al
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end - start;
+// max_depth verilmezse yol uzunluunun gvenlik snr; yollar Rus ruleti bitirir
+static constexpr int default_max_depth = 32;
 
-   // std::cout << "OIDN Denoiser Uyguland, sre: " << elapsed.count() << " saniye." << std::endl;
+static inline float luminance(float r, float g, float b) {
+    return 0.2126f * r + 0.7152f * g + 0.0722f * b;
+}
 
-    const char* errorMessage;
-    if (device.getError(errorMessage) != oidn::Error::None)
-        std::cerr << "OIDN error: " << errorMessage << std::endl;
+float Renderer::estimate_noise(int total_samples) const {
+    if (total_samples < 2 || luminance_sq_buffer.empty())
+        return 0.0f;
+    // Piksel ortalamasnn varyans: s^2 / n, s^2 rnek varyans.
+    const double n = total_samples;
+    double variance_sum = 0.0;
+    double mean_sum = 0.0;
+    for (size_t p = 0; p < luminance_sq_buffer.size(); ++p) {
+        const float* accum = &accumulation_buffer[p * 3];
+        double mean = luminance(accum[0], accum[1], accum[2]) / n;
+        double sample_variance = (luminance_sq_buffer[p] / n - mean * mean) * n / (n - 1.0);
+        variance_sum += std::max(sample_variance, 0.0) / n;
+        mean_sum += mean;
+    }
+    const double pixels = static_cast<double>(luminance_sq_buffer.size());
+    if (mean_sum <= 0.0)
+        return 0.0f;
+    return static_cast<float>(std::sqrt(variance_sum / pixels) / (mean_sum / pixels));
+}
 
-    std::memcpy(colorBuffer.data(), outputOIDNBuffer.getData(), colorBuffer.size() * sizeof(float));
-    for (int i = 0; i < width * height; ++i) {
-        Uint8 r_orig, g_orig, b_orig;
-        SDL_GetRGB(pixels[i], surface->format, &r_orig, &g_orig, &b_orig);
+int Renderer::plan_next_pass(int samples_done, int last_pass_samples, double pass_seconds,
+    double elapsed, double denoise_reserve, float noise) const {
+    const int remaining = settings.max_samples_per_pixel - samples_done;
+    if (remaining <= 0)
+        return 0;
+    // Geiler en fazla toplam rnek saysn ikiye katlar; nizleme sk gncellenir
+    // ve durma noktas ok almaz.
+    int next = std::min(remaining, std::max(settings.samples_per_pass, samples_done));
+
+    if (settings.noise_target > 0.0f && samples_done >= 2) {
+        if (noise <= settings.noise_target)
+            return 0;
+        // Hata 1/sqrt(n) ile azalr: n' = n * (noise / target)^2
+        double ratio = noise / settings.noise_target;
+        int needed = static_cast<int>(std::ceil(samples_done * ratio * ratio)) - samples_done;
+        next = std::min(next, std::max(needed, 1));
+    }
 
-        float r_denoised = colorBuffer[i * 3];
-        float g_denoised = colorBuffer[i * 3 + 1];
-        float b_denoised = colorBuffer[i * 3 + 2];
+    if (settings.time_budget > 0.0f) {
+        // llen hz (spp bana saniye), %5 pay ile
+        double seconds_per_sample = 1.05 * pass_seconds / std::max(last_pass_samples, 1);
+        double left = settings.time_budget - elapsed - denoise_reserve;
+        if (left <= 0.0)
+            return 0;
+        if (seconds_per_sample > 0.0) {
+            double affordable = std::floor(left / seconds_per_sample);
+            if (affordable < 1.0)
+                return 0;
+            next = static_cast<int>(std::min<double>(next, affordable));
+        }
+    }
+    return next;
+}
 
-        Uint8 r = static_cast<Uint8>((r_denoised * blend + r_orig / 255.0f * (1 - blend)) * 255);
-        Uint8 g = static_cast<Uint8>((g_denoised * blend + g_orig / 255.0f * (1 - blend)) * 255);
-        Uint8 b = static_cast<Uint8>((b_denoised * blend + b_orig / 255.0f * (1 - blend)) * 255);
+void Renderer::build_light_sampling(const std::vector<std::shared_ptr<Light>>& lights, float scene_radius) {
+    light_table.build(lights);
+    sun_cache.clear();
+    // Az kta dz alias tablosu daha ucuz; ok kta nokta bana nem veren aa
+    if (lights.size() >= light_tree_min_lights)
+        light_sampler = std::make_unique<LightTree>();
+    else
+        light_sampler = std::make_unique<AliasLightSampler>();
+    light_sampler->build(lights, scene_radius);
+}
 
-        pixels[i] = SDL_MapRGB(surface->format, r, g, b);
-    }
+// Lineer rengi gamma 2 ile kodlayp yzeye yazar. Satr, yzeyin satr srasdr.
+static void store_pixel(SDL_Surface* surface, int x, int row, float r, float g, float b) {
+    Uint32* pixel = static_cast<Uint32*>(surface->pixels) + row * surface->pitch / 4 + x;
+    int ir = static_cast<int>(256 * clamp(std::sqrt(std::max(r, 0.0f)), 0.0f, 0.999f));
+    int ig = static_cast<int>(256 * clamp(std::sqrt(std::max(g, 0.0f)), 0.0f, 0.999f));
+    int ib = static_cast<int>(256 * clamp(std::sqrt(std::max(b, 0.0f)), 0.0f, 0.999f));
+    *pixel = SDL_MapRGB(surface->format, ir, ig, ib);
 }
 
+bool Renderer::denoise_to_surface(SDL_Surface* surface, int total_samples, float blend) {
+    if (total_samples <= 0 || !denoiser.prepare(image_width, image_height))
+        return false;
 
+    const float inv_samples = 1.0f / total_samples;
+    for (size_t k = 0; k < accumulation_buffer.size(); ++k) {
+        denoise_input[k] = accumulation_buffer[k] * inv_samples;
+        denoise_albedo[k] = clamp(albedo_buffer[k] * inv_samples, 0.0f, 1.0f);
+        denoise_normal[k] = normal_buffer[k] * inv_samples;
+    }
 
-Renderer::Renderer( int image_width, int image_height, int samples_per_pixel, int max_depth)
-    : image_width(image_width), image_height(image_height),  aspect_ratio(static_cast<double>(image_width) / image_height), halton_cache(MAX_DIMENSIONS, std::vector<float>(MAX_SAMPLES)) 
-    {
-    initialize_halton_cache();
+    if (!denoiser.denoise(denoise_input.data(), denoise_albedo.data(), denoise_normal.data()))
+        return false;
+
+    // Blend in linear space; the accumulation buffer itself stays untouched.
+    const float* denoised = denoiser.output();
+    for (int row = 0; row < image_height; ++row) {
+        for (int x = 0; x < image_width; ++x) {
+            const size_t k = (static_cast<size_t>(row) * image_width + x) * 3;
+            store_pixel(surface, x, row,
+                denoised[k] * blend + denoise_input[k] * (1 - blend),
+                denoised[k + 1] * blend + denoise_input[k + 1] * (1 - blend),
+                denoised[k + 2] * blend + denoise_input[k + 2] * (1 - blend));
+        }
+    }
+    return true;
 }
-
-Renderer::~Renderer() {}
 void Renderer::set_window(SDL_Window* win) {
     window = win;
 }
@@ -127,8 +149,10 @@ void Renderer::draw_progress_bar(SDL_Surface* surface, float progress) {
    
 }
 
-void Renderer::render_image(SDL_Surface* surface, SDL_Window* window, const int total_samples_per_pixel, const int samples_per_pass) {
-    unsigned int num_threads = std::thread::hardware_concurrency();
+bool Renderer::render_image(SDL_Surface* surface, SDL_Window* window, const int total_samples_per_pixel, const int samples_per_pass) {
+    unsigned int num_threads = settings.num_threads > 0 ? settings.num_threads : std::thread::hardware_concurrency();
+    if (num_threads == 0)
+        num_threads = 1;
     std::vector<std::thread> threads;
     // std::cout << "Starting render with " << num_threads << " threads" << std::endl;
     auto start_time = std::chrono::steady_clock::now();
@@ -139,22 +163,43 @@ void Renderer::render_image(SDL_Surface* surface, SDL_Window* window, const int
     auto create_scene_end_time = std::chrono::steady_clock::now();
     auto create_scene_duration = std::chrono::duration<double, std::milli>(create_scene_end_time - start_time);
     std::cout << "Create Scene Duration: " << create_scene_duration.count() / 1000 << " seconds" << std::endl;
+    if (world.size() == 0) {
+        std::cerr << "Scene is empty, nothing to render." << std::endl;
+        return false;
+    }
+    // Zaman btesi / grlt hedefi modunda toplam rnek says sabit deil;
+    // gei boyutu llen hza gre seilir ve yalnzca gei snrnda durulur.
+    const bool budgeted = settings.time_budget > 0.0 || settings.noise_target > 0.0f;
+    const int sample_limit = budgeted ? settings.max_samples_per_pixel : total_samples_per_pixel;
+
     float blend = 0.2;
     float blendfac = 0;
-    if (total_samples_per_pixel > 0)
-        blendfac = 0.4 / total_samples_per_pixel;
-    std::thread display_thread(&Renderer::update_display, this, window, surface);
-
-    const int num_passes = (total_samples_per_pixel + samples_per_pass - 1) / samples_per_pass;
-
-    for (int pass = 0; pass < num_passes; ++pass) {
-        std::cout << "Starting pass " << pass + 1 << " of " << num_passes << std::endl;
+    if (sample_limit > 0)
+        blendfac = 0.4 / sample_limit;
+    auto render_start_time = std::chrono::steady_clock::now();
+    initializeBuffers(image_width, image_height);
+    if (budgeted && settings.denoise)
+        denoiser.prepare(image_width, image_height);   // cihaz kurulumu da bteye dahil
+    auto last_denoise_time = render_start_time;
+    rendering_complete = false;
+    std::thread display_thread;
+    if (window)
+        display_thread = std::thread(&Renderer::update_display, this, window, surface);
+
+    int samples_done = 0;
+    int pass_samples = std::min(samples_per_pass, sample_limit);
+    int pass = 0;
+    float noise = 0.0f;
+
+    while (pass_samples > 0) {
+        std::cout << "Starting pass " << pass + 1 << " (" << pass_samples << " spp)" << std::endl;
+        auto pass_start_time = std::chrono::steady_clock::now();
 
         next_row.store(0);  // Reset next_row for each pass
 
         for (unsigned int t = 0; t < num_threads; ++t) {
             threads.emplace_back(&Renderer::render_worker, this, image_height, surface, std::ref(world),
-                std::ref(lights), background_color, bvh.get(), samples_per_pass, pass * samples_per_pass);
+                std::ref(lights), background_color, bvh.get(), pass_samples, samples_done);
 
         }
 
@@ -163,31 +208,73 @@ void Renderer::render_image(SDL_Surface* surface, SDL_Window* window, const int
         }
 
         threads.clear();
+        samples_done += pass_samples;
+        ++pass;
+
+        auto pass_end_time = std::chrono::steady_clock::now();
+        double pass_seconds = std::chrono::duration<double>(pass_end_time - pass_start_time).count();
+        double elapsed = std::chrono::duration<double>(pass_end_time - render_start_time).count();
+        if (settings.noise_target > 0.0f)
+            noise = estimate_noise(samples_done);
 
         // Her geiten sonra ilerleme ubuunu gncelle
-        float progress = static_cast<float>(pass + 1) / num_passes;
+        float progress = static_cast<float>(samples_done) / sample_limit;
+        if (settings.time_budget > 0.0)
+            progress = std::max(progress, static_cast<float>(elapsed / settings.time_budget));
+        progress = std::min(progress, 1.0f);
         // draw_progress_bar(surface, progress);
 
         std::cout << "\rRendering progress: " << std::fixed << std::setprecision(2) << progress << "%" << std::flush;
         // Pencere baln gncelle
 
-        blend = blend + blendfac;
+        blend = blend + blendfac * pass_samples;
 
-        char title[100];
-        snprintf(title, sizeof(title), "Rendering... %.1f%% Complete", progress * 100);
-        SDL_SetWindowTitle(window, title);
-      
-        applyOIDNDenoising(surface, 0, true, blend);
-        SDL_UpdateWindowSurface(window);
+        if (budgeted) {
+            // Son denoise sresi bteden ayrlr. Henz llmediyse ilk geiten
+            // sonra bir kez denoise edilerek llr.
+            if (settings.denoise && settings.time_budget > 0.0 && denoiser.last_seconds() <= 0.0) {
+                denoise_to_surface(surface, samples_done, blend);
+                last_denoise_time = std::chrono::steady_clock::now();
+                elapsed = std::chrono::duration<double>(last_denoise_time - render_start_time).count();
+            }
+            double denoise_reserve = settings.denoise ? denoiser.last_seconds() * 1.2 : 0.0;
+            pass_samples = plan_next_pass(samples_done, pass_samples, pass_seconds, elapsed, denoise_reserve, noise);
+        }
+        else {
+            pass_samples = std::min(samples_per_pass, sample_limit - samples_done);
+        }
+
+        // Ara denoise yalnzca pencere varken ve zaman btesi izin verdiinde
+        const bool last_pass = pass_samples <= 0;
+        if (window && settings.denoise && !last_pass) {
+            auto now = std::chrono::steady_clock::now();
+            double since_last = std::chrono::duration<double>(now - last_denoise_time).count();
+            if (denoiser.within_budget(since_last, settings.denoise_budget)) {
+                denoise_to_surface(surface, samples_done, blend);
+                last_denoise_time = std::chrono::steady_clock::now();
+            }
+        }
+        if (window) {
+            char title[100];
+            snprintf(title, sizeof(title), "Rendering... %.1f%% Complete", progress * 100);
+            SDL_SetWindowTitle(window, title);
+            SDL_UpdateWindowSurface(window);
+        }
       
-        std::cout << "Pass " << pass + 1 << " completed. Progress: " << (progress * 100) << "%" << std::endl;
+        std::cout << "Pass " << pass << " completed. Progress: " << (progress * 100) << "%";
+        if (settings.noise_target > 0.0f)
+            std::cout << " noise: " << noise;
+        std::cout << std::endl;
 
     }
 
     rendering_complete = true;
-    display_thread.join();
-    applyOIDNDenoising(surface, 0, true, 0.8f);
-    SDL_UpdateWindowSurface(window);
+    if (display_thread.joinable())
+        display_thread.join();
+    if (settings.denoise)
+        denoise_to_surface(surface, samples_done, 0.8f);
+    if (window)
+        SDL_UpdateWindowSurface(window);
     std::cout << "\nRender completed." << std::endl;
     auto render_end_time = std::chrono::steady_clock::now();
 
@@ -196,9 +283,23 @@ void Renderer::render_image(SDL_Surface* surface, SDL_Window* window, const int
 
     std::cout << "Render Duration: " << render_duration.count() / 1000 << " seconds" << std::endl;
     std::cout << "Total Duration: " << total_duration.count() / 1000 << " seconds" << std::endl;
+    if (Log::suppressed() > 0)
+        LOG_INFO(Log::suppressed() << " repeated log messages were suppressed");
+
+    stats.scene_seconds = create_scene_duration.count() / 1000;
+    stats.render_seconds = render_duration.count() / 1000;
+    stats.total_seconds = total_duration.count() / 1000;
+    stats.object_count = world.size();
+    stats.light_count = lights.size();
+    stats.samples_per_pixel = samples_done;
+    stats.num_threads = num_threads;
+    stats.denoise_seconds = denoiser.total_seconds();
+    stats.noise_estimate = estimate_noise(samples_done);
 
     // Render tamamlandnda pencere baln gncelle
-    SDL_SetWindowTitle(window, "Render Completed");
+    if (window)
+        SDL_SetWindowTitle(window, "Render Completed");
+    return true;
 }
 
 // Texture ykleme fonksiyonu
@@ -211,78 +312,97 @@ struct ObjFile {
 };
 
 std::pair<HittableList, std::shared_ptr<ParallelBVHNode>> Renderer::create_scene(std::vector<std::shared_ptr<Light>>& lights, Vec3SIMD& background_color) {
-    
+    using clock = std::chrono::steady_clock;
+    auto ms_since = [](clock::time_point t) { return std::chrono::duration<double, std::milli>(clock::now() - t).count(); };
+
     HittableList world;
-    Vec3 v0, v1, v2;
-    background_color = { 0.4, 0.5, 0.6 };   
-   
-    std::vector<std::string> model_files = {
-          {"e:/data/home/flower.gltf"},        
-      
-    // dier dosya ve malzeme iftlerini buraya ekleyebilirsiniz
-    };
+    background_color = scene.background_color;
 
     AssimpLoader assimpLoader;
-    baseDirectory = model_files[0];
- 
-    std::string full_path = model_files[0];
-    // Sadece dizin yolunu almak iin std::filesystem kullanyoruz
-    std::filesystem::path path(full_path);
-    baseDirectory = path.parent_path().string() + "/";
-    std::cout << "Dosyann dizin yolu: " << baseDirectory << std::endl;
-
-    std::vector<std::pair<Vec3, double>> object_bounds;
-    for (const auto& model_file : model_files) {
-        std::vector<std::shared_ptr<Triangle>> triangles = assimpLoader.loadModelToTriangles(model_file);
+    auto t = clock::now();
+    for (const auto& model : scene.models) {
+        // Modelin texture yollar kendi dizinine gre zlr
+        std::filesystem::path path(model.path);
+        baseDirectory = path.parent_path().string() + "/";
+        std::cout << "Dosyann dizin yolu: " << baseDirectory << std::endl;
+
+        std::shared_ptr<Material> override_material;
+        if (model.material.override_material)
+            override_material = SceneLoader::create_material(model.material);
+        const Matrix4x4 transform = model.transform.matrix();
+
+        std::vector<std::shared_ptr<Triangle>> triangles = assimpLoader.loadModelToTriangles(model.path);
+        if (triangles.empty())
+            LOG_WARN("Model contains no triangles: " << model.path);
 
         for (const auto& triangle : triangles) {
-           
+            if (override_material)
+                triangle->setMaterial(override_material);
+            if (!model.transform.is_identity)
+                triangle->set_transform(transform);
             world.add(triangle);
         }
     }
-   
-    auto add_object = [&](std::shared_ptr<Hittable> obj, const Vec3& center, double size) {
-        world.add(obj);
-        object_bounds.emplace_back(center, size);
-        };
-
-    if (lights.empty()) {  // Iklar zaten eklenmise tekrar ekleme
-       // const auto& newLights = assimpLoader.getLights();
-      //  lights.insert(lights.end(), newLights.begin(), newLights.end());
-        std::cout << "Toplam eklenen k says: " << lights.size() << std::endl;
-
+    // Ykleme bitti; malzemeler artk deimez
+    scene_materials.compile();
+    double models_ms = ms_since(t);
+
+    t = clock::now();
+    for (const auto& light : scene.lights)
+        lights.push_back(SceneLoader::create_light(light));
+    // Yayan mesh genleri de k olarak rneklenir (indeksleri genlere yazlr)
+    size_t emissive_triangles = TriangleLight::collect(world.objects, lights);
+    if (emissive_triangles > 0)
+        std::cout << "Emissive triangles sampled as lights: " << emissive_triangles << std::endl;
+    if (!scene.background_texture.empty()) {
+        background_texture = std::make_shared<Texture>(scene.background_texture);
+        // Dalm (CDF) burada bir kez kurulur
+        auto environment = std::make_shared<EnvironmentLight>(background_texture);
+        if (environment->valid())
+            lights.push_back(environment);
     }
+    std::cout << "Toplam eklenen k says: " << lights.size() << std::endl;
+    double lights_ms = ms_since(t);
 
-    //lights.push_back(std::make_shared<PointLight>(Vec3(-1.8, 1.68635, 0.5), Vec3(0.3, 0.3, 0.3),0));
-    //lights.push_back(std::make_shared<PointLight>(Vec3(-2.2, 1.5, 0.5), Vec3(0.2, 0.2, 0.1), 0));
-    lights.push_back(std::make_shared<DirectionalLight>(Vec3(5.0, -2, 2.0), Vec3(0.7, 0.6, 0.3),40.0));    
-   //lights.push_back(std::make_shared<AreaLight>(Vec3(2.2, 2.0, 0.8), Vec3(2, -0.5, -0.9), Vec3(2, -1.0, -0.9), 1.0, 1.0, Vec3(1.0, 1.0, 1.0)));
-  
+    t = clock::now();
+    const SceneCamera& cam = scene.camera;
+    camera = Camera(cam.lookfrom, cam.lookat, cam.vup, cam.vfov, aspect_ratio, cam.aperture, cam.focus_dist, cam.blade_count);
+    camera_position = cam.lookfrom;
+    double camera_ms = ms_since(t);
 
-   float rx = 85.1262;
-   float ry = -66.3824;
-   float rz = 0.840447;
-   Vec3 forward;
-   forward.x = cos(ry) * cos(rz);
-   forward.y = sin(rz);
-   forward.z = sin(ry) * cos(rz);
-
-   Vec3 lookfrom(-1.8146, 0.290968, -0.381726);
-   Vec3 lookat(0, 0.0, 0);
-   Vec3 vup(0, 1, 0);
-   int blade_count = 4;
-   double vfov = 40.0;
-   double aperture = 0.0;
-   double focus_dist = 30.0;
-  
-   Vec3 lookfrom1(-2.6, 1.1, 1.8);
-   Vec3 lookat1(2.6, 0.5, -1.3);
-  
-  
-   camera = Camera(lookfrom1, lookat1, vup, vfov, aspect_ratio, aperture, focus_dist, blade_count);
     std::cout << "Total objects in the scene: " << world.size() << std::endl;
-    // BVH'yi olutur       
+    if (world.size() == 0)
+        return std::make_pair(world, std::shared_ptr<ParallelBVHNode>());
+
+    // BVH'yi olutur
+    t = clock::now();
     auto bvh = std::make_shared<ParallelBVHNode>(world.objects, 0, world.objects.size(), 0.0, 1.0);
+    double bvh_ms = ms_since(t);
+
+    // Ynl klarn gc sahne boyutuna gre leklenir
+    AABB scene_box;
+    float scene_radius = 1.0f;
+    const bool has_box = bvh->bounding_box(0.0, 1.0, scene_box);
+    if (has_box)
+        scene_radius = std::max(0.5f * (scene_box.max - scene_box.min).length(), 1e-3f);
+    build_light_sampling(lights, scene_radius);
+    if (settings.sun_cache) {
+        t = clock::now();
+        if (sun_cache.build(world.objects, light_table))
+            std::cout << std::fixed << std::setprecision(3) << "Sun visibility cache: " << sun_cache.entry_count()
+                << " entries, " << ms_since(t) << " ms" << std::endl;
+    }
+    // nbellek her create_scene'de, yani her render_image arsnda sfrdan kurulur;
+    // yalnz o render'n geileri arasnda dolar
+    if (settings.radiance_cache && has_box)
+        radiance_cache.build(scene_box);
+    else
+        radiance_cache.clear();
+    if (settings.radiance_cache && settings.wavefront)
+        LOG_WARN("The wavefront integrator does not use the radiance cache");
+
+    std::cout << std::fixed << std::setprecision(3) << "Scene build (" << scene.source << "): models " << models_ms
+        << " ms, lights " << lights_ms << " ms, camera " << camera_ms << " ms, bvh " << bvh_ms << " ms" << std::endl;
     return std::make_pair(world, bvh);
 }
 std::uniform_int_distribution<> dis_width(0, image_width - 1);
@@ -292,45 +412,70 @@ void Renderer::render_chunk(int start_row, int end_row, SDL_Surface* surface, co
     const std::vector<std::shared_ptr<Light>>& lights, const Vec3& background_color,
     const ParallelBVHNode* bvh, const int samples_per_pass, const int current_sample) {
    
+    if (settings.wavefront) {
+        // Kuyruklar i parac bana bir kez ayrlr ve geiler arasnda yeniden kullanlr
+        static thread_local WavefrontIntegrator integrator;
+        integrator.render_rows(*this, bvh, background_color, start_row, end_row, samples_per_pass,
+            [&](int i, int j, const PixelSums& sums) {
+                accumulate_pixel(surface, i, j, sums, samples_per_pass, current_sample);
+            });
+        return;
+    }
+
     // Chunk iindeki pikselleri ile
     for (int j = end_row; j >= start_row; --j) {
         for (int i = 0; i < image_width; ++i) {
-            Vec3 new_color(0, 0, 0);
+            PixelSums sums;
             // Accumulate colors from multiple samples
             for (int s = 0; s < samples_per_pass; ++s) {
                 // Generate ray
                 Vec2 uv = stratified_halton(i, j, 0, samples_per_pass);
                 Ray r = camera.get_ray(uv.u, uv.v);
                 // Calculate ray color
-                new_color += ray_color(r, bvh, lights, background_color, MAX_DEPTH, 0);
+                PathAOV aov;
+                Vec3SIMD sample_color = ray_color(r, bvh, lights, background_color, &aov);
+                sums.add(sample_color, aov);
             }
-
-            // Mevcut rengi al (lineer uzayda)
-            std::lock_guard<std::mutex> lock(mtx);
-            Uint32* pixel = static_cast<Uint32*>(surface->pixels) + (image_height - 1 - j) * surface->pitch / 4 + i;
-            Uint8 r, g, b;
-            SDL_GetRGB(*pixel, surface->format, &r, &g, &b);
-            Vec3 existing_color(r / 255.0, g / 255.0, b / 255.0);
-            existing_color = Vec3(existing_color.x * existing_color.x, existing_color.y * existing_color.y, existing_color.z * existing_color.z); // Gamma decode
-
-            // Mevcut ve yeni renkleri lineer uzayda birletir
-            int total_samples = current_sample + samples_per_pass;
-            Vec3 combined_color = (existing_color * current_sample + new_color) / total_samples;
-
-            // Gamma dzeltmesi
-            combined_color = Vec3(sqrt(combined_color.x), sqrt(combined_color.y), sqrt(combined_color.z));
-
-            // Rengi SDL piksel formatna dntr
-            int ir = static_cast<int>(256 * clamp(combined_color.x, 0.0, 0.999));
-            int ig = static_cast<int>(256 * clamp(combined_color.y, 0.0, 0.999));
-            int ib = static_cast<int>(256 * clamp(combined_color.z, 0.0, 0.999));
-
-            // SDL yzeyinde piksel rengini ayarla
-            *pixel = SDL_MapRGB(surface->format, ir, ig, ib);
+            accumulate_pixel(surface, i, j, sums, samples_per_pass, current_sample);
         }
     }
 }
 
+void PixelSums::add(const Vec3SIMD& sample_color, const PathAOV& aov) {
+    color += sample_color;
+    float y = luminance(sample_color.x(), sample_color.y(), sample_color.z());
+    luminance_sq += y * y;
+    albedo += aov.albedo;
+    normal += aov.normal;
+    ao += aov.ao;
+}
+
+void Renderer::accumulate_pixel(SDL_Surface* surface, int i, int j, const PixelSums& sums,
+    int samples_per_pass, int current_sample) {
+    // Lineer float birikim tamponuna ekle. Her satr tek bir i paracna
+    // ait olduu iin kilit gerekmez.
+    const int row = image_height - 1 - j;
+    float* accum = &accumulation_buffer[(static_cast<size_t>(row) * image_width + i) * 3];
+    accum[0] += sums.color.x();
+    accum[1] += sums.color.y();
+    accum[2] += sums.color.z();
+
+    luminance_sq_buffer[static_cast<size_t>(row) * image_width + i] += sums.luminance_sq;
+
+    const size_t aux_index = (static_cast<size_t>(row) * image_width + i) * 3;
+    albedo_buffer[aux_index] += sums.albedo.x();
+    albedo_buffer[aux_index + 1] += sums.albedo.y();
+    albedo_buffer[aux_index + 2] += sums.albedo.z();
+    normal_buffer[aux_index] += sums.normal.x();
+    normal_buffer[aux_index + 1] += sums.normal.y();
+    normal_buffer[aux_index + 2] += sums.normal.z();
+    if (!ao_buffer.empty())
+        ao_buffer[static_cast<size_t>(row) * image_width + i] += sums.ao;
+
+    const float inv_samples = 1.0f / (current_sample + samples_per_pass);
+    store_pixel(surface, i, row, accum[0] * inv_samples, accum[1] * inv_samples, accum[2] * inv_samples);
+}
+
 void Renderer::render_worker(int image_height, SDL_Surface* surface, const HittableList& world,
     const std::vector<std::shared_ptr<Light>>& lights, const Vec3& background_color,
     const ParallelBVHNode* bvh, const int samples_per_pass, const int current_sample) {
@@ -369,31 +514,21 @@ void Renderer::update_display(SDL_Window* window, SDL_Surface* surface) {
 }
 
 
-std::vector<Vec3SIMD> Renderer::normalMapBuffer;
-std::mutex Renderer::normalMapBufferMutex;
-
-
 // Yeni metod: Normal map uygulama
-Vec3SIMD Renderer::apply_normal_map(const HitRecord& rec) {
+Vec3SIMD Renderer::apply_normal_map(const HitRecord& rec, const CompiledMaterial& material) {
 
-    if (rec.material->has_normal_map()) {
+    if (material.normal_map) {
         Vec3SIMD tangent, bitangent;
         create_coordinate_system(rec.normal.normalize(), tangent, bitangent);
-        Vec3SIMD normal_from_map = rec.material->get_normal_from_map(rec.u, rec.v);
+        Vec3SIMD normal_from_map = material.material->get_normal_from_map(rec.u, rec.v);
         normal_from_map = normal_from_map * 1.75 - Vec3(1, 1, 1);
-        normal_from_map *= rec.material->get_normal_strength();
+        normal_from_map *= material.normal_strength;
         Vec3SIMD transformed_normal(
             tangent.x() * normal_from_map.x() + bitangent.x() * normal_from_map.y() + rec.normal.x() * normal_from_map.z(),
             tangent.y() * normal_from_map.x() + bitangent.y() * normal_from_map.y() + rec.normal.y() * normal_from_map.z(),
             tangent.z() * normal_from_map.x() + bitangent.z() * normal_from_map.y() + rec.normal.z() * normal_from_map.z()
         );
-
-        std::lock_guard<std::mutex> lock(normalMapBufferMutex);
-
-        normalMapBuffer.push_back(normal_from_map.normalize());
-
-         normalMapBuffer.push_back(rec.material->get_normal_from_map(rec.u, rec.v).normalize()); 
-            return transformed_normal.normalize();
+        return transformed_normal.normalize();
     }
     return Vec3SIMD(rec.normal.normalize());
 }
@@ -460,103 +595,118 @@ Vec2 Renderer::stratified_halton(int x, int y, int sample_index, int samples_per
     return Vec2((x + u) / image_width, (y + v) / image_height);
 }
 
-Vec3SIMD Renderer::ray_color(const Ray& r, const ParallelBVHNode* bvh, const std::vector<std::shared_ptr<Light>>& lights, const Vec3SIMD& background_color, int depth, int sample_index) {
+Vec3SIMD Renderer::ray_color(const Ray& r, const ParallelBVHNode* bvh, const std::vector<std::shared_ptr<Light>>& lights, const Vec3SIMD& background_color, PathAOV* aov) {
     Vec3SIMD final_color(0, 0, 0);
     Vec3SIMD throughput(1, 1, 1);
     Ray current_ray = r;
     float total_distance = 0.0f;
     Vec3SIMD sky_color;   
-    const int MAX_DEPTH_DIELECTRIC = 15;
-    const int MAX_DEPTH_VOLUMETRIC = 20;
-    const int MAX_DEPTH_METAL = 6;
-    const int MAX_DEPTH_PrincipledBSDF = 6;
-    const int MIN_DEPTH = 3;
-    const int MAX_DEPTH = std::max({ MAX_DEPTH_DIELECTRIC, MAX_DEPTH_VOLUMETRIC, MAX_DEPTH_METAL, MAX_DEPTH_PrincipledBSDF });
-    const float BASE_THRESHOLD = 0.01f;
-    const float DISTANCE_FACTOR = 0.001f;
-
-    //static int global_sample_index = 0;
-    static std::atomic<int> global_sample_index(0);
-    int local_sample_index = global_sample_index.fetch_add(1, std::memory_order_relaxed);
+    const int MAX_DEPTH = path_max_depth();
+
+    // Bir nceki salmann MIS bilgisi: BSDF n bir alan na arparsa kullanlr
+    Vec3SIMD prev_point(0, 0, 0);
+    float prev_bsdf_pdf = 0.0f;
+    bool prev_specular = true;
+
+    // Inm nbellei: yaynk kelerin kan nm yol bitince
+    // (son renk - kedeki renk) / kedeki throughput olarak yazlr
+    struct CacheVertex {
+        uint32_t slot;
+        Vec3SIMD color_before;
+        Vec3SIMD throughput;
+    };
+    CacheVertex cache_vertices[RadianceCache::max_path_vertices];
+    int cache_vertex_count = 0;
+    const bool use_radiance_cache = radiance_cache.valid();
 
     for (int bounce = 0; bounce < MAX_DEPTH; ++bounce) {
-        // Dinamik erken k stratejisi
-        float dynamic_threshold = BASE_THRESHOLD + (total_distance * DISTANCE_FACTOR);
-        if (bounce > MIN_DEPTH) {
-            float max_component = throughput.max_component();
-            float continuation_probability = std::min(max_component, 0.95f);
-
-            if (get_halton_value(local_sample_index, 0) > continuation_probability || max_component < dynamic_threshold) {
-                break;
-            }
-
-            throughput /= continuation_probability;
+        if (!continue_path(bounce, throughput)) {
+            break;
         }
         HitRecord rec;
-        if (!bvh->hit(current_ray, EPSILON, std::numeric_limits<double>::infinity(), rec)) {
-            if (atmosphericEffects.enable) {
-                if (background_texture) {
-                    float u = 0.5f + std::atan2(current_ray.direction.z(), current_ray.direction.x()) / (2 * M_PI);
-                    float v = 0.5f - std::asin(current_ray.direction.y()) / M_PI;
-                    sky_color = background_texture->get_color(u, v);
-                }
-                else {
-                    sky_color = background_color;
-                }
-                final_color += throughput * atmosphericEffects.applyAtmosphericEffects(sky_color, total_distance);
-            }
-            else {
-                final_color += throughput * background_color;
-            }
+        const bool hit_surface = bvh->hit(current_ray, EPSILON, std::numeric_limits<double>::infinity(), rec);
+
+        // Alan klar BVH'de deil; n nce birine arpyorsa yaylan  ekle ve dur
+        int area_index = -1;
+        float area_t = 0.0f;
+        const float surface_t = hit_surface ? static_cast<float>(rec.t) : std::numeric_limits<float>::infinity();
+        if (light_sampler && light_table.intersect(current_ray, surface_t, area_index, area_t)) {
+            float weight = 1.0f;
+            if (bounce > 0 && !prev_specular)
+                weight = emission_mis_weight(area_index, current_ray, area_t, prev_point, prev_bsdf_pdf);
+            final_color += throughput * light_table.radiance(area_index) * weight;
             break;
         }
 
+        if (!hit_surface) {
+            // Arka plan dokusu bir k olarak da rneklenir; ayn yn ikisi de bulabilir
+            const EnvironmentLight* environment = light_table.environment;
+            sky_color = environment ? environment->radiance(current_ray.direction) : background_color;
+            float weight = 1.0f;
+            if (environment && light_sampler && bounce > 0 && !prev_specular)
+                weight = emission_mis_weight(light_table.environment_index, current_ray,
+                    std::numeric_limits<float>::infinity(), prev_point, prev_bsdf_pdf);
+            if (aov && bounce == 0)
+                aov->albedo = sky_color;
+            if (atmosphericEffects.active())
+                sky_color = atmosphericEffects.applyAtmosphericEffects(sky_color, total_distance);
+            final_color += throughput * sky_color * weight;
+            break;
+        }
+
+        const CompiledMaterial& material = scene_materials.compiled(rec.material_id);
         Vec3SIMD original_normal(rec.normal);
-        Vec3SIMD transformed_normal = apply_normal_map(rec);
+        Vec3SIMD transformed_normal = apply_normal_map(rec, material);
         rec.normal = static_cast<Vec3SIMD>(transformed_normal);
+        if (aov && bounce == 0) {
+            aov->albedo = material.material->get_albedo(rec.u, rec.v);
+            aov->normal = transformed_normal;
+            if (settings.ao_samples > 0)
+                aov->ao = ambient_occlusion(bvh, rec.point, transformed_normal);
+        }
 
         float segment_distance = rec.t;
         total_distance += segment_distance;
 
-        if (atmosphericEffects.enable) {
+        if (atmosphericEffects.active()) {
             throughput = atmosphericEffects.attenuateSegment(throughput, total_distance - segment_distance, total_distance);
             Vec3SIMD segment_contribution = atmosphericEffects.calculateSegmentContribution(total_distance - segment_distance, total_distance);
             final_color += throughput * segment_contribution;
         }
 
-        int max_depth_for_material;
-        switch (rec.material->type()) {
-        case MaterialType::Dielectric:
-            max_depth_for_material = MAX_DEPTH_DIELECTRIC;
-            break;
-        case MaterialType::Volumetric:
-            max_depth_for_material = MAX_DEPTH_VOLUMETRIC;
-            break;
-        case MaterialType::Metal:
-            max_depth_for_material = MAX_DEPTH_METAL;
-            break;
-        case MaterialType::PrincipledBSDF:
-        default:
-            max_depth_for_material = MAX_DEPTH_PrincipledBSDF;
-            break;
-        }
-
-        if (bounce >= max_depth_for_material && bounce >= MIN_DEPTH) {
-            break;
+        // Yalnz baktan bamsza yakn (yaynk arlkl) yzeyler; parlak PrincipledBSDF
+        // vurgular baka ynlere tard. Yayan genler MIS arl ald iin girmez
+        if (use_radiance_cache && rec.light_index < 0 && material.diffuse) {
+            Vec3SIMD cached;
+            if (bounce > 0 && radiance_cache.lookup(rec.point, original_normal, cached)) {
+                final_color += throughput * cached;
+                break;
+            }
+            if (cache_vertex_count < RadianceCache::max_path_vertices)
+                cache_vertices[cache_vertex_count++] = { radiance_cache.slot(rec.point, original_normal), final_color, throughput };
         }
        
 
-        Vec3SIMD emitted = Vec3SIMD(rec.material->emitted(rec.u, rec.v, rec.point));
-        final_color += throughput * emitted;
-        if (rec.material->type() == MaterialType::Dielectric) {
+        Vec3SIMD emitted = MaterialDispatch::emitted(material, rec);
+        if (emitted.max_component() > 0.0f) {
+            // Ik listesindeki yayan genler dorudan kta da rneklenir
+            float weight = 1.0f;
+            if (rec.light_index >= 0 && light_sampler && bounce > 0 && !prev_specular)
+                weight = emission_mis_weight(rec.light_index, current_ray, static_cast<float>(rec.t), prev_point, prev_bsdf_pdf);
+            final_color += throughput * emitted * weight;
+        }
+        if (material.type == MaterialType::Dielectric) {
             Vec3SIMD attenuation;
             Ray scattered;
-            bool is_scattered = rec.material->scatter(current_ray, rec, attenuation, scattered);
+            float scatter_pdf;
+            bool is_scattered = MaterialDispatch::sample(material, current_ray, rec, attenuation, scattered, scatter_pdf);
 
             if (!is_scattered) break;
 
             throughput *= Vec3SIMD(attenuation);
             current_ray = scattered;
+            prev_point = rec.point;
+            prev_specular = true;
 
         }
 
@@ -565,232 +715,267 @@ Vec3SIMD Renderer::ray_color(const Ray& r, const ParallelBVHNode* bvh, const std
         else {
             Vec3SIMD attenuation;
             Ray scattered;
-            if (!rec.material->scatter(current_ray, rec, attenuation, scattered)) {
+            float scatter_pdf = 0.0f;
+            if (!MaterialDispatch::sample(material, current_ray, rec, attenuation, scattered, scatter_pdf)) {
                 break;
             }
 
-            if (rec.material->type() != MaterialType::Dielectric && rec.material->type() != MaterialType::Volumetric) {
-                Vec3SIMD direct_light = calculate_direct_lighting(bvh, lights, rec, rec.normal);
-                final_color += throughput * Vec3SIMD(attenuation) * direct_light;
+            if (!material.specular) {
+                Vec3SIMD direct_light = calculate_direct_lighting(bvh, lights, rec, -current_ray.direction.normalize());
+                final_color += throughput * direct_light;
             }
 
+            prev_point = rec.point;
+            prev_specular = material.specular;
+            prev_bsdf_pdf = prev_specular ? 0.0f : scatter_pdf;
+
             rec.normal = static_cast<Vec3>(original_normal);
 
             // Salan k zayflamas
-            float scattering_attenuation = 1.0f / (1.0f + total_distance *  rec.material->get_scattering_factor()); // Ayarlanabilir faktr
+            float scattering_attenuation = 1.0f / (1.0f + total_distance * material.scattering_factor); // Ayarlanabilir faktr
            
             throughput *= Vec3SIMD(attenuation) * scattering_attenuation;
-           
-            // Rus ruleti
-            if (bounce > MIN_DEPTH) {
-                float p;
-                switch (rec.material->type()) {
-                case MaterialType::Dielectric:
-                case MaterialType::Volumetric:
-                    p = std::max(0.8f, std::min(0.99f, throughput.max_component()));
-                    break;
-                case MaterialType::Metal:
-                    p = std::max(0.5f, std::min(0.97f, throughput.max_component()));
-                    break;
-                case MaterialType::PrincipledBSDF:
-                default:
-                    p = std::max(0.3f, std::min(0.95f, throughput.max_component()));
-                    break;
-                }
-
-                if (get_halton_value(local_sample_index + bounce, 1) >= p) {
-                    break;
-                }
-                throughput /= p;
-            }
 
             current_ray = scattered;
         }
     }
 
+    for (int i = 0; i < cache_vertex_count; ++i) {
+        const CacheVertex& vertex = cache_vertices[i];
+        if (vertex.slot == RadianceCache::npos)
+            continue;
+        const Vec3SIMD& tp = vertex.throughput;
+        if (tp.x() < 1e-4f || tp.y() < 1e-4f || tp.z() < 1e-4f)
+            continue;
+        Vec3SIMD gathered = final_color - vertex.color_before;
+        Vec3SIMD radiance(gathered.x() / tp.x(), gathered.y() / tp.y(), gathered.z() / tp.z());
+        // Tek bir parlak rnek btn hcreyi boyamasn
+        float peak = radiance.max_component();
+        if (peak > 32.0f)
+            radiance *= 32.0f / peak;
+        radiance_cache.add(vertex.slot, radiance);
+    }
+
     return final_color;
 }
 
-Vec3SIMD Renderer::calculate_light_contribution(
-    const std::shared_ptr<Light>& light,
-    const Vec3SIMD& point,
-    const Vec3SIMD& geometric_normal,
-    const Vec3SIMD& shading_normal,
-    const Vec3SIMD& view_direction,
-    float shininess,
-    float metallic,
-    bool is_global
-) {
-    Vec3SIMD to_light;
-    Vec3SIMD intensity = light->intensity;
-    float distance = 0.0f;
-    bool is_directional = false;
+int Renderer::path_max_depth() const {
+    return settings.max_depth > 0 ? settings.max_depth : default_max_depth;
+}
 
-    if (auto directional_light = std::dynamic_pointer_cast<DirectionalLight>(light)) {
-      
-        distance = 1000.0f; // Assume a far distance for directional lights
-        is_directional = true;     
-        Vec3SIMD point_vec3 = point;
-       
-        to_light = - directional_light->random_point().normalize(); 
-            
-    }
-    else if (auto point_light = std::dynamic_pointer_cast<PointLight>(light)) {
-        Vec3SIMD light_pos = point_light->getPosition();
-        Vec3SIMD point_vec3 = point;
-        to_light = light_pos - point_vec3;
-        distance = to_light.length();
-        to_light = to_light.normalize();
-        is_directional = false;
-        intensity = point_light->getIntensity() / (distance * distance);
-    }
-    else if (auto spot_light = std::dynamic_pointer_cast<SpotLight>(light)) {
-        Vec3SIMD light_pos = spot_light->position;
-        Vec3SIMD point_vec3 = point;
-        to_light = light_pos - point_vec3;
-        distance = to_light.length();
-        to_light = to_light.normalize();
-        is_directional = false;
-
-        // Spot n yn ile noktaya olan yn arasndaki ay kontrol et
-        float cos_theta = Vec3::dot(to_light, spot_light->direction);
-        if (cos_theta > std::cos(spot_light->angle_degrees)) {
-            // Eer nokta spot n konisi iindeyse, k iddetini hesapla
-            float falloff = std::pow(cos_theta, 2.0f);  // Cosine falloff; exponent ayarlanabilir
-            intensity = spot_light->intensity * falloff / (distance * distance);
-        }
-        else {
-            // Nokta spot n konisi dnda, bu yzden k iddeti sfr
-            intensity = Vec3SIMD(0.0, 0.0, 0.0);
-        }
-    }
+bool Renderer::continue_path(int bounce, Vec3SIMD& throughput) const {
+    if (bounce <= settings.roulette_depth || settings.roulette_threshold <= 0.0f)
+        return true;
+    // Rus ruleti: hayatta kalma olasl throughput ile orantl, eiin stnde 1.
+    // Kalan yol olasla blnr; beklenen deer deimez,  az tayan yollar
+    // ise n harcamadan biter. Tek bir karar, malzemeden bamsz.
+    const float survival = std::min(1.0f, throughput.max_component() / settings.roulette_threshold);
+    if (survival >= 1.0f)
+        return true;
+    if (ThreadLocalRNG::instance().get() >= survival)
+        return false;
+    throughput /= survival;
+    return true;
+}
 
-    else if (auto area_light = std::dynamic_pointer_cast<AreaLight>(light)) {
-        Vec3SIMD random_light_pos = area_light->random_point();
-        Vec3SIMD point_vec3 = point;
-        to_light = random_light_pos - point_vec3;
-        distance = to_light.length();
-        to_light = to_light.normalize();
-        is_directional = false;
-        double area = area_light->getWidth() * area_light->getHeight();
-        double intensity_factor = area_light->getIntensity().length() / area;
-        double attenuation = 1.0 / (distance * distance);
-        intensity = area_light->getIntensity() * attenuation;
+float Renderer::emission_mis_weight(int light_index, const Ray& ray, float t, const Vec3SIMD& from, float bsdf_pdf) const {
+    // Ayn yolu k rneklemesi de retebilirdi (calculate_direct_lighting)
+    const float dir_length = ray.direction.length();
+    const Vec3SIMD to_light = ray.direction / dir_length;
+    float pdf_light = light_sampler->pdf(light_index, from) *
+        light_table.solid_angle_pdf(light_index, from, to_light, t * dir_length);
+    // Ik taraf bir grup rnek aldysa saysyla arlklanr
+    return power_heuristic(bsdf_pdf, pdf_light * area_light_batch(light_index));
+}
+
+float Renderer::ambient_occlusion(const ParallelBVHNode* bvh, const Vec3SIMD& point, const Vec3SIMD& normal) {
+    ThreadLocalRNG& rng = ThreadLocalRNG::instance();
+    const int samples = settings.ao_samples;
+    int unoccluded = 0;
+    // 32'lik paketler; her paket BVH'de tek gei
+    Ray rays[32];
+    float t_max[32];
+    for (int first = 0; first < samples; first += 32) {
+        const int count = std::min(32, samples - first);
+        for (int s = 0; s < count; ++s) {
+            rays[s] = Ray(point, MicrofacetLobes::sample_cosine(rng.get(), rng.get(), normal));
+            t_max[s] = settings.ao_radius;
+        }
+        const uint32_t active = count == 32 ? 0xffffffffu : (1u << count) - 1;
+        unoccluded += count - std::popcount(bvh->occluded_packet(rays, t_max, active, 1e-3));
     }
+    return static_cast<float>(unoccluded) / samples;
+}
 
-    // Light atmospheric effect
-    float fog_density = 0.00f;
-    float haze_density = 0.0f;
-    float atmospheric_attenuation = expf(-distance * (fog_density + haze_density));
-    intensity = intensity * atmospheric_attenuation;
-
-    __m256 cos_theta_vec = Vec3SIMD::dot(shading_normal, to_light).data;
-    // cos(theta) deerini 0 ile 1 arasnda snrlyoruz
-    cos_theta_vec = _mm256_max_ps(_mm256_set1_ps(0.0f), cos_theta_vec);  // 0'dan kk deerleri 0 yap
-    cos_theta_vec = _mm256_min_ps(_mm256_set1_ps(1.0f), cos_theta_vec);  // 1'den byk deerleri 1 yap
-
-    // Eer global illumination aktifse, k younluunu artr
-    __m256 intensity_vec = intensity.data;
-    if (is_global) {
-        intensity_vec = _mm256_mul_ps(intensity_vec, _mm256_set1_ps(1.3f));  // intensity * 1.3
+bool Renderer::save_ao_image(const std::string& path) const {
+    if (ao_buffer.empty() || stats.samples_per_pixel <= 0)
+        return false;
+    SDL_Surface* image = SDL_CreateRGBSurfaceWithFormat(0, image_width, image_height, 24, SDL_PIXELFORMAT_RGB24);
+    if (image == nullptr)
+        return false;
+    // AO dorusal bir oran; grntde olduu gibi saklanr
+    const float inv_samples = 1.0f / stats.samples_per_pixel;
+    for (int row = 0; row < image_height; ++row) {
+        Uint8* line = static_cast<Uint8*>(image->pixels) + row * image->pitch;
+        for (int x = 0; x < image_width; ++x) {
+            float ao = clamp(ao_buffer[static_cast<size_t>(row) * image_width + x] * inv_samples, 0.0f, 1.0f);
+            Uint8 value = static_cast<Uint8>(ao * 255.0f + 0.5f);
+            line[x * 3] = line[x * 3 + 1] = line[x * 3 + 2] = value;
+        }
     }
+    bool saved = IMG_SavePNG(image, path.c_str()) == 0;
+    SDL_FreeSurface(image);
+    return saved;
+}
 
-    __m256 result_vec = _mm256_mul_ps(intensity_vec, cos_theta_vec);
+int Renderer::area_light_batch(int light_index) const {
+    const LightType type = light_table.type[light_index];
+    if (type != LightType::Area && type != LightType::Triangle)
+        return 1;
+    int side = static_cast<int>(std::lround(std::sqrt(static_cast<float>(std::max(settings.area_light_samples, 1)))));
+    side = std::clamp(side, 1, 5);
+    return side * side;
+}
 
-    // Sonucu Vec3SIMD objesine dntrp dndr
-    Vec3SIMD result;
-    result.data = result_vec;
-    return result;
+Vec3SIMD Renderer::calculate_light_contribution(
+    int light_index,
+    const Vec3SIMD& point,
+    const Vec3SIMD& to_light,
+    float distance
+) {
+    Vec3SIMD intensity = light_table.incident(light_index, point, to_light, distance);
+    if (!atmosphericEffects.active())
+        return intensity;
+    // Assume a far distance for directional lights
+    float falloff_distance = std::isinf(distance) ? 1000.0f : distance;
+    return intensity * atmosphericEffects.lightTransmittance(falloff_distance);
 }
 
 Vec3SIMD Renderer::calculate_direct_lighting(
     const ParallelBVHNode* bvh,
     const std::vector<std::shared_ptr<Light>>& lights,
     const HitRecord& rec,
-    const Vec3SIMD& normal
+    const Vec3SIMD& wo
 ) {
-    const Vec3SIMD& background_color = Vec3(0, 0, 0);
+    ShadowRay shadow[max_shadow_rays];
+    const int count = prepare_direct_lighting(rec, wo, shadow);
     Vec3SIMD direct_light(0, 0, 0);
+    if (count == 1) {
+        if (!shadow_occluded(bvh, shadow[0]))
+            direct_light = shadow[0].contribution;
+        return direct_light;
+    }
+    if (count == 0)
+        return direct_light;
+
+    // Alan  grubu: glge nlar tek paket halinde izlenir
+    Ray rays[max_shadow_rays];
+    float t_max[max_shadow_rays];
+    for (int s = 0; s < count; ++s) {
+        rays[s] = shadow[s].ray;
+        t_max[s] = shadow[s].t_max;
+    }
+    const uint32_t active = (1u << count) - 1;
+    // Her rnek yalnzca kendi grnrlyle saylr
+    const uint32_t visible = active & ~bvh->occluded_packet(rays, t_max, active, 0.01);
+    for (uint32_t bits = visible; bits; bits &= bits - 1)
+        direct_light += shadow[std::countr_zero(bits)].contribution;
+    return direct_light;
+}
+
+int Renderer::prepare_direct_lighting(const HitRecord& rec, const Vec3SIMD& wo, ShadowRay* out) {
+    const CompiledMaterial& material = scene_materials.compiled(rec.material_id);
+    if (light_table.empty() || !light_sampler || material.specular)
+        return 0;
     const Vec3SIMD& hit_point = rec.point;
-    const Vec3SIMD& hit_normal = normal;  // Use the provided normal instead of rec.normal
-    Vec3SIMD shading_normal = apply_normal_map(rec);
-    HitRecord shadow_rec;  // Create a single HitRecord object and reuse it
-    Vec3SIMD view_direction = (camera_position - hit_point).normalize();
-    // Sadece rastgele seilmi bir k kaynan rnekle
-    ThreadLocalRNG rng;
-    int light_index = static_cast<int>(rng.get() * lights.size());
-    const auto& light = lights[light_index];
-    float shininess = rec.material->get_shininess();
-    float metallic = rec.material->get_metallic();
-    Vec3SIMD to_light;
-    float light_distance = std::numeric_limits<float>::infinity();
-    Vec3SIMD light_contribution;
-    Ray shadow_ray(hit_point, to_light);
-    float transmittance = 1.0f;
-    bool blocked = false;
 
-   
+    // Gc ile orantl tek bir k se: tek glge n, katk / pdf
+    float light_pdf = 0.0f;
+    ThreadLocalRNG& rng = ThreadLocalRNG::instance();
+    int light_index = light_sampler->sample(rng.get(), hit_point, light_pdf);
+    if (light_index < 0 || light_pdf <= 0.0f)
+        return 0;
+    if (area_light_batch(light_index) > 1)
+        return prepare_area_light(light_index, light_pdf, rec, wo, out);
 
-    if (!blocked) {
-        direct_light += light_contribution * transmittance;
+    Vec3SIMD to_light;
+    float light_distance = 0.0f;
+    const float u1 = rng.get();
+    const float u2 = rng.get();
+    if (!light_table.sample_direction(light_index, hit_point, u1, u2, to_light, light_distance))
+        return 0;
+
+    // BSDF * cos; ray_color normal haritasn rec.normal'a zaten uygulad
+    float pdf_bsdf = 0.0f;
+    Vec3SIMD f = MaterialDispatch::eval(material, rec, wo, to_light, pdf_bsdf);
+    if (f.max_component() <= 0.0f)
+        return 0;
+
+    Vec3SIMD light_contribution = f * calculate_light_contribution(light_index, hit_point, to_light, light_distance);
+    if (light_contribution.max_component() <= 0.0f)
+        return 0;
+
+    // Alan klarna BSDF nlar da arpabilir (ray_color); ikisini power heuristic ile birletir
+    float weight = 1.0f;
+    if (!light_table.is_delta(light_index)) {
+        float pdf_light = light_pdf * light_table.solid_angle_pdf(light_index, hit_point, to_light, light_distance);
+        weight = power_heuristic(pdf_light, pdf_bsdf);
     }
-    for (const auto& light : lights) {
-       
-        if (const auto* directional_light = dynamic_cast<const DirectionalLight*>(light.get())) {
-            //to_light = -directional_light->direction.normalize();
-           
-          
-            to_light =  - directional_light->random_point().normalize();
-            light_contribution = calculate_light_contribution(light, hit_point, hit_normal, shading_normal, view_direction, shininess, metallic);
-        }
-        else if (const auto* point_light = dynamic_cast<const PointLight*>(light.get())) {
-            to_light = Vec3SIMD(point_light->getPosition()) - hit_point;
-            light_distance = to_light.length();
-            to_light = to_light.normalize();
-            light_contribution = calculate_light_contribution(light, hit_point, hit_normal, shading_normal, view_direction, shininess, metallic);
-        }
-        else if (const auto* spot_light = dynamic_cast<const SpotLight*>(light.get())) {
-            to_light = Vec3SIMD(spot_light->position) - hit_point;
-            light_distance = to_light.length();
-            to_light = to_light.normalize();
-
-            // Spot n yn ile noktann konumu arasndaki ay kontrol et
-            float cos_theta = to_light.dot(spot_light->direction);
-            if (cos_theta > std::cos(spot_light->angle_degrees)) {
-                // Spot k konisinin iindeyse katky hesapla
-                float falloff = std::pow(cos_theta, 2.0f); // Cosine falloff; exponent ayarlanabilir
-                light_contribution = calculate_light_contribution(light, hit_point, hit_normal, shading_normal, view_direction, shininess, metallic) * falloff;
-            }
-            else {
-                // Nokta koni dnda, katk sfr
-                light_contribution = Vec3SIMD(0.0f, 0.0f, 0.0f);
-            }
-        }
-        else if (const auto* area_light = dynamic_cast<const AreaLight*>(light.get())) {
-            constexpr int num_samples = 16;
-            const float area = area_light->getWidth() * area_light->getHeight();
-            const float intensity_factor = area_light->getIntensity().length() / area;
-            Vec3SIMD area_light_contribution(0, 0, 0);
-
-            for (int i = 0; i < num_samples; ++i) {
-                Vec3SIMD sample_point = area_light->random_point();
-                to_light = sample_point - hit_point;
-                light_distance = to_light.length();
-                to_light = to_light.normalize();
-                area_light_contribution += calculate_light_contribution(light, hit_point, hit_normal, shading_normal, view_direction, shininess, metallic);
-            }
 
-            light_contribution = area_light_contribution / static_cast<float>(num_samples);
-        }
-        else {
-            continue;
-        }
+    // In kendi geni BVH'de; uzakln hemen nnde durulur
+    out[0].ray = Ray(hit_point, to_light);
+    out[0].t_max = light_distance * 0.999f;
+    out[0].contribution = light_contribution * (weight / light_pdf);
+    out[0].sun = light_index == sun_cache.light();
+    return 1;
+}
 
-        if (!bvh->hit(Ray(hit_point, to_light), 0.01f, light_distance, shadow_rec)) {
+bool Renderer::shadow_occluded(const ParallelBVHNode* bvh, const ShadowRay& shadow) const {
+    // Gne nlar nce k uzayndaki zgaraya sorulur; sonu BVH ile ayndr
+    if (shadow.sun)
+        return sun_cache.occluded(shadow.ray.origin, shadow.ray.direction, 0.01f, bvh);
+    return bvh->occluded(shadow.ray, 0.01f, shadow.t_max);
+}
 
-            direct_light += light_contribution;
-        }
+int Renderer::prepare_area_light(
+    int light_index,
+    float light_pdf,
+    const HitRecord& rec,
+    const Vec3SIMD& wo,
+    ShadowRay* out
+) {
+    const int count = area_light_batch(light_index);
+    const int side = static_cast<int>(std::lround(std::sqrt(static_cast<float>(count))));
+    const float inv_side = 1.0f / side;
+    const Vec3SIMD& hit_point = rec.point;
+    const CompiledMaterial& material = scene_materials.compiled(rec.material_id);
+    ThreadLocalRNG& rng = ThreadLocalRNG::instance();
+
+    // Her hcreden bir nokta; grnrlk hari her ey nceden hesaplanr
+    int prepared = 0;
+    for (int s = 0; s < count; ++s) {
+        const float u1 = ((s % side) + rng.get()) * inv_side;
+        const float u2 = ((s / side) + rng.get()) * inv_side;
+        Vec3SIMD to_light;
+        float distance = 0.0f;
+        if (!light_table.sample_direction(light_index, hit_point, u1, u2, to_light, distance))
+            continue;
+        float pdf_bsdf = 0.0f;
+        Vec3SIMD f = MaterialDispatch::eval(material, rec, wo, to_light, pdf_bsdf);
+        if (f.max_component() <= 0.0f)
+            continue;
+        Vec3SIMD c = f * calculate_light_contribution(light_index, hit_point, to_light, distance);
+        if (c.max_component() <= 0.0f)
+            continue;
+
+        // count rnekli k stratejisi, tek BSDF rneine kar
+        float pdf_light = count * light_pdf * light_table.solid_angle_pdf(light_index, hit_point, to_light, distance);
+        float weight = power_heuristic(pdf_light, pdf_bsdf);
+        ShadowRay& shadow = out[prepared++];
+        shadow.ray = Ray(hit_point, to_light);
+        shadow.t_max = distance * 0.999f;
+        shadow.contribution = c * (weight / (count * light_pdf));
+        shadow.sun = false;
     }
-   
-    return direct_light;
+    return prepared;
 }
@@ -0,0 +1,478 @@
+#include "SceneLoader.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <filesystem>
+#include <initializer_list>
+#include <type_traits>
+#include "json.hpp"
+#include "PrincipledBSDF.h"
+#include "Metal.h"
+#include "Dielectric.h"
+#include "DirectionalLight.h"
+#include "PointLight.h"
+#include "SpotLight.h"
+#include "AreaLight.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+// Collects every problem in the file instead of stopping at the first one,
+// so a broken scene can be fixed in a single edit/run cycle.
+struct SceneValidator {
+    std::vector<std::string> errors;
+    std::vector<std::string> warnings;
+
+    void error(const std::string& where, const std::string& what) { errors.push_back(where + ": " + what); }
+    void warning(const std::string& where, const std::string& what) { warnings.push_back(where + ": " + what); }
+
+    void check_keys(const json& obj, const std::string& where, std::initializer_list<const char*> known) {
+        for (auto it = obj.begin(); it != obj.end(); ++it) {
+            bool found = false;
+            for (const char* key : known) {
+                if (it.key() == key) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                warning(where, "unknown key \"" + it.key() + "\" ignored");
+        }
+    }
+
+    bool read_vec3(const json& obj, const char* key, Vec3& out, const std::string& where) {
+        if (!obj.contains(key))
+            return false;
+        const json& value = obj[key];
+        if (!value.is_array() || value.size() != 3 || !value[0].is_number() || !value[1].is_number() || !value[2].is_number()) {
+            error(where, std::string("\"") + key + "\" must be an array of 3 numbers");
+            return false;
+        }
+        out = Vec3(value[0].get<double>(), value[1].get<double>(), value[2].get<double>());
+        return true;
+    }
+
+    template <typename T>
+    bool read_number(const json& obj, const char* key, T& out, const std::string& where) {
+        if (!obj.contains(key))
+            return false;
+        if (!obj[key].is_number()) {
+            error(where, std::string("\"") + key + "\" must be a number");
+            return false;
+        }
+        // get<int>() would truncate 2.5 to 2 without a word
+        if (std::is_integral_v<T> && !obj[key].is_number_integer()) {
+            error(where, std::string("\"") + key + "\" must be an integer");
+            return false;
+        }
+        out = obj[key].get<T>();
+        return true;
+    }
+
+    bool read_string(const json& obj, const char* key, std::string& out, const std::string& where) {
+        if (!obj.contains(key))
+            return false;
+        if (!obj[key].is_string()) {
+            error(where, std::string("\"") + key + "\" must be a string");
+            return false;
+        }
+        out = obj[key].get<std::string>();
+        return true;
+    }
+
+    void require_positive(double value, const char* key, const std::string& where) {
+        if (!(value > 0.0))
+            error(where, std::string("\"") + key + "\" must be greater than zero");
+    }
+};
+
+std::string resolve_path(const std::filesystem::path& base, const std::string& path) {
+    if (path.empty())
+        return path;
+    std::filesystem::path p(path);
+    if (p.is_absolute())
+        return p.string();
+    return (base / p).lexically_normal().string();
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void parse_transform(SceneValidator& v, const json& obj, SceneTransform& transform, const std::string& where) {
+    if (!obj.is_object()) {
+        v.error(where, "must be an object");
+        return;
+    }
+    v.check_keys(obj, where, { "translate", "rotate", "scale" });
+    v.read_vec3(obj, "translate", transform.translate, where);
+    v.read_vec3(obj, "rotate", transform.rotate_degrees, where);
+    if (v.read_vec3(obj, "scale", transform.scale, where)) {
+        if (transform.scale.x == 0.0 || transform.scale.y == 0.0 || transform.scale.z == 0.0)
+            v.error(where, "\"scale\" components must be non-zero");
+    }
+    transform.is_identity = false;
+}
+
+void parse_material(SceneValidator& v, const json& obj, const std::filesystem::path& base, SceneMaterial& material, const std::string& where) {
+    if (!obj.is_object()) {
+        v.error(where, "must be an object");
+        return;
+    }
+    v.check_keys(obj, where, { "type", "color", "roughness", "metallic", "ior", "emission", "emission_strength", "texture" });
+    material.override_material = true;
+    v.read_string(obj, "type", material.type, where);
+    if (material.type != "principled" && material.type != "metal" && material.type != "dielectric")
+        v.error(where, "unknown material type \"" + material.type + "\" (principled, metal, dielectric)");
+    v.read_vec3(obj, "color", material.color, where);
+    v.read_number(obj, "roughness", material.roughness, where);
+    v.read_number(obj, "metallic", material.metallic, where);
+    if (v.read_number(obj, "ior", material.ior, where))
+        v.require_positive(material.ior, "ior", where);
+    v.read_vec3(obj, "emission", material.emission, where);
+    v.read_number(obj, "emission_strength", material.emission_strength, where);
+    if (v.read_string(obj, "texture", material.texture, where))
+        material.texture = resolve_path(base, material.texture);
+}
+
+void parse_models(SceneValidator& v, const json& root, const std::filesystem::path& base, SceneDescription& scene) {
+    if (!root.contains("models")) {
+        v.error("models", "missing, the scene needs at least one model");
+        return;
+    }
+    const json& models = root["models"];
+    if (!models.is_array() || models.empty()) {
+        v.error("models", "must be a non-empty array");
+        return;
+    }
+    for (size_t i = 0; i < models.size(); ++i) {
+        const std::string where = "models[" + std::to_string(i) + "]";
+        const json& obj = models[i];
+        if (!obj.is_object()) {
+            v.error(where, "must be an object");
+            continue;
+        }
+        v.check_keys(obj, where, { "path", "transform", "material" });
+        SceneModel model;
+        if (!v.read_string(obj, "path", model.path, where) || model.path.empty()) {
+            v.error(where, "\"path\" is required");
+            continue;
+        }
+        model.path = resolve_path(base, model.path);
+        if (!std::filesystem::exists(model.path))
+            v.error(where, "file not found: " + model.path);
+        if (obj.contains("transform"))
+            parse_transform(v, obj["transform"], model.transform, where + ".transform");
+        if (obj.contains("material"))
+            parse_material(v, obj["material"], base, model.material, where + ".material");
+        scene.models.push_back(model);
+    }
+}
+
+void parse_lights(SceneValidator& v, const json& root, SceneDescription& scene) {
+    if (!root.contains("lights"))
+        return;
+    const json& lights = root["lights"];
+    if (!lights.is_array()) {
+        v.error("lights", "must be an array");
+        return;
+    }
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const std::string where = "lights[" + std::to_string(i) + "]";
+        const json& obj = lights[i];
+        if (!obj.is_object()) {
+            v.error(where, "must be an object");
+            continue;
+        }
+        v.check_keys(obj, where, { "type", "position", "direction", "intensity", "radius", "angle", "u", "v", "width", "height" });
+        std::string type;
+        v.read_string(obj, "type", type, where);
+        SceneLight light;
+        if (type == "directional") {
+            light.type = LightType::Directional;
+            if (!v.read_vec3(obj, "direction", light.direction, where))
+                v.error(where, "directional light needs \"direction\"");
+        }
+        else if (type == "point") {
+            light.type = LightType::Point;
+            if (!v.read_vec3(obj, "position", light.position, where))
+                v.error(where, "point light needs \"position\"");
+        }
+        else if (type == "spot") {
+            light.type = LightType::Spot;
+            if (!v.read_vec3(obj, "position", light.position, where) || !v.read_vec3(obj, "direction", light.direction, where))
+                v.error(where, "spot light needs \"position\" and \"direction\"");
+            if (v.read_number(obj, "angle", light.angle_degrees, where) && (light.angle_degrees <= 0.0f || light.angle_degrees > 180.0f))
+                v.error(where, "\"angle\" must be in (0, 180] degrees");
+        }
+        else if (type == "area") {
+            light.type = LightType::Area;
+            if (!v.read_vec3(obj, "position", light.position, where))
+                v.error(where, "area light needs \"position\"");
+            v.read_vec3(obj, "u", light.u, where);
+            v.read_vec3(obj, "v", light.v, where);
+            if (v.read_number(obj, "width", light.width, where))
+                v.require_positive(light.width, "width", where);
+            if (v.read_number(obj, "height", light.height, where))
+                v.require_positive(light.height, "height", where);
+        }
+        else {
+            v.error(where, "unknown light type \"" + type + "\" (directional, point, spot, area)");
+            continue;
+        }
+        v.read_vec3(obj, "intensity", light.intensity, where);
+        if (v.read_number(obj, "radius", light.radius, where) && light.radius < 0.0f)
+            v.error(where, "\"radius\" must not be negative");
+        scene.lights.push_back(light);
+    }
+}
+
+void parse_camera(SceneValidator& v, const json& root, SceneDescription& scene) {
+    if (!root.contains("camera"))
+        return;
+    const json& obj = root["camera"];
+    const std::string where = "camera";
+    if (!obj.is_object()) {
+        v.error(where, "must be an object");
+        return;
+    }
+    v.check_keys(obj, where, { "position", "look_at", "up", "fov", "aperture", "focus_distance", "blade_count" });
+    SceneCamera& camera = scene.camera;
+    v.read_vec3(obj, "position", camera.lookfrom, where);
+    v.read_vec3(obj, "look_at", camera.lookat, where);
+    v.read_vec3(obj, "up", camera.vup, where);
+    if (v.read_number(obj, "fov", camera.vfov, where) && (camera.vfov <= 0.0 || camera.vfov >= 180.0))
+        v.error(where, "\"fov\" must be in (0, 180) degrees");
+    if (v.read_number(obj, "aperture", camera.aperture, where) && camera.aperture < 0.0)
+        v.error(where, "\"aperture\" must not be negative");
+    if (v.read_number(obj, "focus_distance", camera.focus_dist, where))
+        v.require_positive(camera.focus_dist, "focus_distance", where);
+    if (v.read_number(obj, "blade_count", camera.blade_count, where) && camera.blade_count < 3)
+        v.error(where, "\"blade_count\" must be at least 3");
+    Vec3 view = camera.lookat - camera.lookfrom;
+    if (view.length() == 0.0)
+        v.error(where, "\"position\" and \"look_at\" must differ");
+}
+
+void parse_background(SceneValidator& v, const json& root, const std::filesystem::path& base, SceneDescription& scene) {
+    if (!root.contains("background"))
+        return;
+    const json& obj = root["background"];
+    const std::string where = "background";
+    if (!obj.is_object()) {
+        v.error(where, "must be an object");
+        return;
+    }
+    v.check_keys(obj, where, { "color", "texture" });
+    v.read_vec3(obj, "color", scene.background_color, where);
+    if (v.read_string(obj, "texture", scene.background_texture, where)) {
+        scene.background_texture = resolve_path(base, scene.background_texture);
+        if (!std::filesystem::exists(scene.background_texture))
+            v.error(where, "file not found: " + scene.background_texture);
+    }
+}
+
+void parse_sampler(SceneValidator& v, const json& root, SceneDescription& scene) {
+    if (!root.contains("sampler"))
+        return;
+    const json& obj = root["sampler"];
+    const std::string where = "sampler";
+    if (!obj.is_object()) {
+        v.error(where, "must be an object");
+        return;
+    }
+    v.check_keys(obj, where, { "samples_per_pixel", "samples_per_pass", "max_depth",
+                               "roulette_depth", "roulette_threshold", "time_budget", "noise_target", "max_samples_per_pixel" });
+    RenderSettings& settings = scene.settings;
+    if (v.read_number(obj, "samples_per_pixel", settings.samples_per_pixel, where))
+        v.require_positive(settings.samples_per_pixel, "samples_per_pixel", where);
+    if (v.read_number(obj, "samples_per_pass", settings.samples_per_pass, where))
+        v.require_positive(settings.samples_per_pass, "samples_per_pass", where);
+    if (v.read_number(obj, "max_depth", settings.max_depth, where) && settings.max_depth < 0)
+        v.error(where, "\"max_depth\" must not be negative");
+    if (v.read_number(obj, "roulette_depth", settings.roulette_depth, where) && settings.roulette_depth < 0)
+        v.error(where, "\"roulette_depth\" must not be negative");
+    if (v.read_number(obj, "roulette_threshold", settings.roulette_threshold, where) && settings.roulette_threshold < 0.0f)
+        v.error(where, "\"roulette_threshold\" must not be negative");
+    if (v.read_number(obj, "time_budget", settings.time_budget, where) && settings.time_budget < 0.0f)
+        v.error(where, "\"time_budget\" must not be negative");
+    if (v.read_number(obj, "noise_target", settings.noise_target, where) && settings.noise_target < 0.0f)
+        v.error(where, "\"noise_target\" must not be negative");
+    if (v.read_number(obj, "max_samples_per_pixel", settings.max_samples_per_pixel, where))
+        v.require_positive(settings.max_samples_per_pixel, "max_samples_per_pixel", where);
+    const bool adaptive = settings.time_budget > 0.0f || settings.noise_target > 0.0f;
+    const int sample_cap = adaptive ? settings.max_samples_per_pixel : settings.samples_per_pixel;
+    if (settings.samples_per_pass > sample_cap)
+        settings.samples_per_pass = sample_cap;
+}
+
+void parse_render(SceneValidator& v, const json& root, const std::filesystem::path& base, SceneDescription& scene) {
+    if (!root.contains("render"))
+        return;
+    const json& obj = root["render"];
+    const std::string where = "render";
+    if (!obj.is_object()) {
+        v.error(where, "must be an object");
+        return;
+    }
+    v.check_keys(obj, where, { "width", "height", "threads", "output", "denoise", "denoise_budget", "ao_samples", "ao_radius" });
+    RenderSettings& settings = scene.settings;
+    if (v.read_number(obj, "width", settings.width, where))
+        v.require_positive(settings.width, "width", where);
+    if (v.read_number(obj, "height", settings.height, where))
+        v.require_positive(settings.height, "height", where);
+    int threads = 0;
+    if (v.read_number(obj, "threads", threads, where)) {
+        if (threads < 0)
+            v.error(where, "\"threads\" must not be negative");
+        else
+            settings.num_threads = static_cast<unsigned int>(threads);
+    }
+    if (v.read_string(obj, "output", settings.output_path, where))
+        settings.output_path = resolve_path(base, settings.output_path);
+    if (obj.contains("denoise")) {
+        if (obj["denoise"].is_boolean())
+            settings.denoise = obj["denoise"].get<bool>();
+        else
+            v.error(where, "\"denoise\" must be true or false");
+    }
+    if (v.read_number(obj, "denoise_budget", settings.denoise_budget, where) && settings.denoise_budget < 0.0f)
+        v.error(where, "\"denoise_budget\" must not be negative");
+    if (v.read_number(obj, "ao_samples", settings.ao_samples, where) && settings.ao_samples < 0)
+        v.error(where, "\"ao_samples\" must not be negative");
+    if (v.read_number(obj, "ao_radius", settings.ao_radius, where))
+        v.require_positive(settings.ao_radius, "ao_radius", where);
+}
+
+} // namespace
+
+Matrix4x4 SceneTransform::matrix() const {
+    const double to_rad = M_PI / 180.0;
+    return Matrix4x4::translation(translate.x, translate.y, translate.z)
+        * Matrix4x4::rotationZ(rotate_degrees.z * to_rad)
+        * Matrix4x4::rotationY(rotate_degrees.y * to_rad)
+        * Matrix4x4::rotationX(rotate_degrees.x * to_rad)
+        * Matrix4x4::scaling(scale.x, scale.y, scale.z);
+}
+
+SceneDescription SceneLoader::default_scene(const std::string& model_path) {
+    SceneDescription scene;
+    scene.source = "<built-in>";
+    SceneModel model;
+    model.path = model_path.empty() ? "e:/data/home/flower.gltf" : model_path;
+    scene.models.push_back(model);
+
+    SceneLight sun;
+    sun.type = LightType::Directional;
+    sun.direction = Vec3(5.0, -2, 2.0);
+    sun.intensity = Vec3(0.7, 0.6, 0.3);
+    sun.radius = 40.0f;
+    scene.lights.push_back(sun);
+    return scene;
+}
+
+bool SceneLoader::is_scene_file(const std::string& path) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    for (auto& c : ext)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return ext == ".json";
+}
+
+bool SceneLoader::load(const std::string& path, SceneDescription& scene) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Scene file could not be opened: " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string text = buffer.str();
+    double read_ms = elapsed_ms(start);
+
+    auto t = std::chrono::steady_clock::now();
+    // No exceptions: a discarded value signals a syntax error.
+    json root = json::parse(text, nullptr, false);
+    double parse_ms = elapsed_ms(t);
+    if (root.is_discarded() || !root.is_object()) {
+        std::cerr << "Scene file is not a valid JSON object: " << path << std::endl;
+        return false;
+    }
+
+    scene = SceneDescription();
+    scene.source = path;
+    const std::filesystem::path base = std::filesystem::path(path).parent_path();
+    SceneValidator v;
+    v.check_keys(root, "scene", { "models", "lights", "camera", "background", "sampler", "render" });
+
+    t = std::chrono::steady_clock::now();
+    parse_models(v, root, base, scene);
+    double models_ms = elapsed_ms(t);
+
+    t = std::chrono::steady_clock::now();
+    parse_lights(v, root, scene);
+    double lights_ms = elapsed_ms(t);
+
+    t = std::chrono::steady_clock::now();
+    parse_camera(v, root, scene);
+    parse_background(v, root, base, scene);
+    double camera_ms = elapsed_ms(t);
+
+    t = std::chrono::steady_clock::now();
+    parse_sampler(v, root, scene);
+    parse_render(v, root, base, scene);
+    double settings_ms = elapsed_ms(t);
+
+    for (const auto& w : v.warnings)
+        std::cout << "Scene warning: " << w << std::endl;
+    for (const auto& e : v.errors)
+        std::cerr << "Scene error: " << e << std::endl;
+
+    std::cout << std::fixed << std::setprecision(3)
+        << "Scene file " << path << ": read " << read_ms << " ms, parse " << parse_ms
+        << " ms, models " << models_ms << " ms, lights " << lights_ms
+        << " ms, camera " << camera_ms << " ms, settings " << settings_ms
+        << " ms, total " << elapsed_ms(start) << " ms" << std::endl;
+
+    return v.errors.empty();
+}
+
+std::shared_ptr<Material> SceneLoader::create_material(const SceneMaterial& desc) {
+    if (desc.type == "dielectric")
+        return std::make_shared<Dielectric>(desc.ior, Vec3SIMD(desc.color));
+
+    std::shared_ptr<Texture> texture;
+    if (!desc.texture.empty())
+        texture = std::make_shared<Texture>(desc.texture);
+
+    if (desc.type == "metal") {
+        if (texture)
+            return std::make_shared<Metal>(texture, desc.roughness, desc.metallic, 0.0f, 0.0f);
+        return std::make_shared<Metal>(desc.color, desc.roughness, desc.metallic, 0.0f, 0.0f);
+    }
+
+    std::shared_ptr<PrincipledBSDF> material = texture
+        ? std::make_shared<PrincipledBSDF>(texture, desc.roughness, desc.metallic, PrincipledBSDF::TextureTransform())
+        : std::make_shared<PrincipledBSDF>(desc.color, desc.roughness, desc.metallic);
+    if (desc.emission_strength > 0.0f)
+        material->setEmission(desc.emission, desc.emission_strength);
+    return material;
+}
+
+std::shared_ptr<Light> SceneLoader::create_light(const SceneLight& desc) {
+    switch (desc.type) {
+    case LightType::Point:
+        return std::make_shared<PointLight>(desc.position, desc.intensity, desc.radius);
+    case LightType::Spot:
+        return std::make_shared<SpotLight>(desc.position, Vec3SIMD(desc.direction).normalize(), desc.intensity, desc.angle_degrees, desc.radius);
+    case LightType::Area:
+        return std::make_shared<AreaLight>(desc.position, desc.u, desc.v, desc.width, desc.height, desc.intensity);
+    case LightType::Directional:
+    default:
+        return std::make_shared<DirectionalLight>(desc.direction, desc.intensity, desc.radius);
+    }
+}
@@ -1,5 +1,5 @@
 #include "SmartUVProjection.h"
-#include <iostream>
+#include "Log.h"
 #include <limits>
 #include <cmath>
 
@@ -8,7 +8,7 @@ SmartUVProjection::SmartUVProjection(std::vector<std::shared_ptr<Triangle>>& tri
 
 void SmartUVProjection::calculateBoundingBox() {
     if (triangles.empty()) {
-        std::cerr << "Error: No triangles to calculate bounding box" << std::endl;
+        LOG_ERROR("No triangles to calculate bounding box");
         return;
     }
 
@@ -26,15 +26,13 @@ void SmartUVProjection::calculateBoundingBox() {
         maxBound = Vec3::max(maxBound, triangle->v2);
     }
 
-    std::cout << "Bounding Box Min: " << minBound.x << ", " << minBound.y << ", " << minBound.z << std::endl;
-    std::cout << "Bounding Box Max: " << maxBound.x << ", " << maxBound.y << ", " << maxBound.z << std::endl;
+    LOG_DEBUG("UV projection bounds (" << minBound.x << ", " << minBound.y << ", " << minBound.z << ") - ("
+        << maxBound.x << ", " << maxBound.y << ", " << maxBound.z << ")");
 }
 
 void SmartUVProjection::apply(ProjectionType type) {
-    std::cout << "Entering apply method with type: " << static_cast<int>(type) << std::endl;
-
     if (triangles.empty()) {
-        std::cerr << "Warning: No Triangle objects found for UV projection." << std::endl;
+        LOG_WARN("No Triangle objects found for UV projection");
         return;
     }
 
@@ -48,7 +46,7 @@ void SmartUVProjection::apply(ProjectionType type) {
         break;
         // Dier projeksiyon trleri burada eklenebilir
     default:
-        std::cerr << "Error: Unsupported projection type" << std::endl;
+        LOG_ERROR("Unsupported projection type " << static_cast<int>(type));
         return;
     }
     normalizeUVCoordinates();
@@ -119,14 +117,14 @@ Vec3 SmartUVProjection::calculateAverageNormal() {
     }
 
     if (validTriangleCount == 0) {
-        std::cerr << "Error: No valid triangles found for normal calculation" << std::endl;
+        LOG_WARN_LIMITED(8, "No valid triangles found for normal calculation");
         return Vec3(0, 1, 0);  // Return a default up vector
     }
 
     avgNormal = avgNormal / validTriangleCount;
 
     if (avgNormal.length() < 1e-6) {
-        std::cerr << "Warning: Average normal is near-zero, using default up vector" << std::endl;
+        LOG_WARN_LIMITED(8, "Average normal is near-zero, using default up vector");
         return Vec3(0, 1, 0);
     }
 
@@ -145,7 +143,7 @@ void SmartUVProjection::createOrthonormalBasis(const Vec3& normal, Vec3& tangent
     // Ensure no `nan` values
     if (std::isnan(tangent.x) || std::isnan(tangent.y) || std::isnan(tangent.z) ||
         std::isnan(bitangent.x) || std::isnan(bitangent.y) || std::isnan(bitangent.z)) {
-        std::cerr << "Error: `nan` values detected in tangent or bitangent calculation" << std::endl;
+        LOG_WARN_LIMITED(8, "`nan` values detected in tangent or bitangent calculation");
         tangent = Vec3(1, 0, 0); // Default tangent
         bitangent = Vec3(0, 1, 0); // Default bitangent
     }
@@ -2,7 +2,7 @@
 
 Sphere::Sphere() {}
 Sphere::Sphere(Vec3 cen, double r, std::shared_ptr<Material> m)
-    : center(cen), radius(r), material(m) {}
+    : center(cen), radius(r), material_id(scene_materials.add(m)) {}
 
 bool Sphere::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
     Vec3 oc = r.origin - center;
@@ -19,7 +19,8 @@ bool Sphere::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const
             rec.point = r.at(rec.t);
             Vec3 outward_normal = (rec.point - center) / radius;
             rec.set_face_normal(r, outward_normal);
-            rec.material = material;
+            rec.material_id = material_id;
+            rec.light_index = -1;
             return true;
         }
         temp = (-b + root) / a;
@@ -28,7 +29,8 @@ bool Sphere::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const
             rec.point = r.at(rec.t);
             Vec3 outward_normal = (rec.point - center) / radius;
             rec.set_face_normal(r, outward_normal);
-            rec.material = material;
+            rec.material_id = material_id;
+            rec.light_index = -1;
             return true;
         }
     }
@@ -2,7 +2,7 @@
 #include <cmath>
 
 SpotLight::SpotLight(const Vec3SIMD& pos, const Vec3SIMD& dir, const Vec3SIMD& intens, float ang, float rad)
-    : angle_degrees(ang), radius(rad) {
+    : angle_degrees(ang), angle_radians(ang * static_cast<float>(M_PI / 180.0)), cos_cone(std::cos(angle_radians)), radius(rad) {
     position = pos;
     direction = dir.normalize();
     intensity = intens;
@@ -18,7 +18,7 @@ Vec3SIMD SpotLight::getIntensity(const Vec3SIMD& point) const {
     float cos_theta = direction.dot (getDirection(point));
 
     // Check if the point is within the spotlight's cone
-    if (cos_theta > std::cos(angle_degrees)) {
+    if (cos_theta > cos_cone) {
         // Intensity falls off as a function of the cosine of the angle
         float falloff = std::pow(cos_theta, 2.0f);  // You can adjust the exponent for different falloff rates
         return intensity * falloff;
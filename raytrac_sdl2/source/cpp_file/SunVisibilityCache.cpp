@@ -0,0 +1,161 @@
+#include "SunVisibilityCache.h"
+#include "ParallelBVHNode.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+void SunVisibilityCache::clear() {
+    light_index = -1;
+    objects.clear();
+    cell_start.clear();
+    entries.clear();
+    entry_top.clear();
+}
+
+bool SunVisibilityCache::build(const std::vector<std::shared_ptr<Hittable>>& scene_objects, const LightTable& table, int resolution) {
+    clear();
+    int sun = -1;
+    for (int i = 0; i < static_cast<int>(table.size()); ++i) {
+        if (table.type[i] == LightType::Directional) {
+            sun = i;
+            break;
+        }
+    }
+    if (sun < 0 || scene_objects.empty() || resolution <= 0)
+        return false;
+
+    // Light space; LightTable::sample_direction jitters the sun by up to
+    // radius at 1000 units along the (unnormalized) direction
+    const float dir_length = table.direction[sun].length();
+    if (dir_length <= 0.0f)
+        return false;
+    axis_w = -(table.direction[sun] / dir_length);
+    Vec3SIMD up = std::abs(axis_w.y()) < 0.999f ? Vec3SIMD(0.0f, 1.0f, 0.0f) : Vec3SIMD(1.0f, 0.0f, 0.0f);
+    axis_u = Vec3SIMD::cross(up, axis_w).normalize();
+    axis_v = Vec3SIMD::cross(axis_w, axis_u);
+    const float jitter = table.radius[sun];
+    const float sun_distance = 1000.0f * dir_length;
+    if (jitter >= 0.5f * sun_distance)
+        return false;
+    tan_max = jitter / (sun_distance - jitter) * 1.01f + 1e-6f;
+
+    // Light space bounds of every object
+    struct Footprint { float u0, u1, v0, v1, bottom, top; };
+    const size_t n = scene_objects.size();
+    std::vector<Footprint> prints(n);
+    float scene_bottom = std::numeric_limits<float>::infinity();
+    for (size_t k = 0; k < n; ++k) {
+        AABB box;
+        if (!scene_objects[k]->bounding_box(0.0, 1.0, box))
+            return false;
+        Footprint f{ INFINITY, -INFINITY, INFINITY, -INFINITY, INFINITY, -INFINITY };
+        for (int c = 0; c < 8; ++c) {
+            Vec3SIMD p((c & 1) ? box.max.x() : box.min.x(), (c & 2) ? box.max.y() : box.min.y(), (c & 4) ? box.max.z() : box.min.z());
+            float pu = p.dot(axis_u), pv = p.dot(axis_v), pw = p.dot(axis_w);
+            f.u0 = std::min(f.u0, pu); f.u1 = std::max(f.u1, pu);
+            f.v0 = std::min(f.v0, pv); f.v1 = std::max(f.v1, pv);
+            f.bottom = std::min(f.bottom, pw); f.top = std::max(f.top, pw);
+        }
+        prints[k] = f;
+        scene_bottom = std::min(scene_bottom, f.bottom);
+    }
+
+    // A ray from the lowest possible point drifts at most (top - bottom) * tan_max
+    float u_min = INFINITY, u_max = -INFINITY, v_min = INFINITY, v_max = -INFINITY;
+    for (Footprint& f : prints) {
+        float grow = (f.top - scene_bottom) * tan_max + 1e-4f * (1.0f + std::abs(f.top));
+        f.u0 -= grow; f.u1 += grow; f.v0 -= grow; f.v1 += grow;
+        u_min = std::min(u_min, f.u0); u_max = std::max(u_max, f.u1);
+        v_min = std::min(v_min, f.v0); v_max = std::max(v_max, f.v1);
+    }
+    const float extent = std::max({ u_max - u_min, v_max - v_min, 1e-4f });
+    res = resolution;
+    origin_u = u_min;
+    origin_v = v_min;
+    inv_cell = res / extent;
+
+    auto cell_range = [&](const Footprint& f, int& x0, int& x1, int& y0, int& y1) {
+        x0 = std::clamp(static_cast<int>((f.u0 - origin_u) * inv_cell), 0, res - 1);
+        x1 = std::clamp(static_cast<int>((f.u1 - origin_u) * inv_cell), 0, res - 1);
+        y0 = std::clamp(static_cast<int>((f.v0 - origin_v) * inv_cell), 0, res - 1);
+        y1 = std::clamp(static_cast<int>((f.v1 - origin_v) * inv_cell), 0, res - 1);
+    };
+
+    // Two passes into CSR: count, then fill
+    std::vector<uint32_t> counts(static_cast<size_t>(res) * res + 1, 0);
+    for (const Footprint& f : prints) {
+        int x0, x1, y0, y1;
+        cell_range(f, x0, x1, y0, y1);
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+                ++counts[static_cast<size_t>(y) * res + x];
+    }
+    cell_start.assign(counts.size(), 0);
+    for (size_t c = 1; c < counts.size(); ++c)
+        cell_start[c] = cell_start[c - 1] + counts[c - 1];
+    entries.resize(cell_start.back());
+    entry_top.resize(cell_start.back());
+
+    std::vector<uint32_t> cursor(cell_start.begin(), cell_start.end() - 1);
+    for (size_t k = 0; k < n; ++k) {
+        int x0, x1, y0, y1;
+        cell_range(prints[k], x0, x1, y0, y1);
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+                entries[cursor[static_cast<size_t>(y) * res + x]++] = static_cast<uint32_t>(k);
+    }
+
+    // Tallest first so a query can stop at the first object below the point
+    for (size_t c = 0; c + 1 < cell_start.size(); ++c) {
+        auto begin = entries.begin() + cell_start[c], end = entries.begin() + cell_start[c + 1];
+        std::sort(begin, end, [&](uint32_t a, uint32_t b) { return prints[a].top > prints[b].top; });
+        for (uint32_t e = cell_start[c]; e < cell_start[c + 1]; ++e)
+            entry_top[e] = prints[entries[e]].top;
+    }
+
+    objects = scene_objects;
+    light_index = sun;
+    return true;
+}
+
+bool SunVisibilityCache::occluded(const Vec3SIMD& point, const Vec3SIMD& to_light, float t_min,
+    const ParallelBVHNode* bvh, Resolution* resolved) const {
+    const Ray ray(point, to_light);
+    HitRecord rec;
+    auto fallback = [&]() {
+        if (resolved)
+            *resolved = Resolution::Fallback;
+        return bvh->hit(ray, t_min, std::numeric_limits<double>::infinity(), rec);
+    };
+
+    // Directions outside the cone the grid was dilated for
+    const float rise = to_light.dot(axis_w);
+    const float drift_sq = to_light.length_squared() - rise * rise;
+    if (rise <= 0.0f || drift_sq > tan_max * tan_max * rise * rise)
+        return fallback();
+
+    if (resolved)
+        *resolved = Resolution::Lit;
+    const int x = static_cast<int>(std::floor((point.dot(axis_u) - origin_u) * inv_cell));
+    const int y = static_cast<int>(std::floor((point.dot(axis_v) - origin_v) * inv_cell));
+    if (x < 0 || y < 0 || x >= res || y >= res)
+        return false;                   // outside every dilated footprint
+
+    const size_t cell = static_cast<size_t>(y) * res + x;
+    const uint32_t begin = cell_start[cell], end = cell_start[cell + 1];
+    const float height = point.dot(axis_w);
+    // Rays only climb; t_min covers the start of the ray
+    if (begin == end || entry_top[begin] < height)
+        return false;
+    if (end - begin > max_cell_objects)
+        return fallback();
+
+    if (resolved)
+        *resolved = Resolution::Tested;
+    for (uint32_t e = begin; e < end && entry_top[e] >= height; ++e) {
+        if (objects[entries[e]]->hit(ray, t_min, std::numeric_limits<double>::infinity(), rec))
+            return true;
+    }
+    return false;
+}
@@ -1,12 +1,13 @@
 // Texture.cpp
 
 #include "Texture.h"
-#include <iostream>
+#include "Log.h"
+#include <algorithm>
 
 Texture::Texture(const std::string& filename) {
     SDL_Surface* surface = IMG_Load(filename.c_str());
     if (!surface) {
-        std::cerr << "Error loading image: " << filename << ", SDL Error: " << IMG_GetError() << std::endl;
+        LOG_ERROR("Error loading image: " << filename << ", SDL Error: " << IMG_GetError());
         return;
     }
 
@@ -17,8 +18,9 @@ Texture::Texture(const std::string& filename) {
     SDL_LockSurface(surface);
     Uint8* pixelData = static_cast<Uint8*>(surface->pixels);
     SDL_PixelFormat* format = surface->format;
-    // Eer format 32-bit deilse, alfa kanal olmayabilir
-    bool has_alpha = (surface->format->BitsPerPixel == 32);
+    // Alfa yalnzca formatta alfa maskesi (veya saydam paletli) varsa saklanr;
+    // RGB dokularda alphas bo kalr ve get_alpha 1 dndrr
+    bool has_alpha = format->Amask != 0 || format->palette != nullptr;
    
     if (has_alpha) {
         alphas.resize(width * height);
@@ -27,29 +29,13 @@ Texture::Texture(const std::string& filename) {
         for (int x = 0; x < width; ++x) {
             Uint8 r, g, b, a;
             Uint32 pixel;
-            alphas.resize(width * height);
             switch (format->BitsPerPixel) {
             case 8: // 8-bit paletteli format
             {
 
                 Uint8* p = pixelData + (y * surface->pitch) + x;
-                pixel = *p;               
-               
-                // Siyah-beyaz olup olmadn kontrol et
-                      // 8-bit paletteli format genellikle gri tonlama olarak kullanlr
-                if (r != g || r != b) {
-                    is_gray_scale = false;
-                }
-
-                // Gri tonlamal piksellerin alfa deerini olutur
-                float gray = *p / 255.0f;
-                // Opacity map ise gri tonlamay alfa olarak kullan
-                if (is_gray_scale) {
-                    alphas[y * width + x] = (gray == 0) ? 0.0f : 1.0f; // Siyah 0, Beyaz 1
-                }
-                else {
-                    pixels[y * width + x] = Vec3(gray / 255.0f, gray / 255.0f, gray / 255.0f);
-                }
+                pixel = *p;
+                // Gri tonlamal opaklk haritalar rengi zerinden okunur
                 SDL_GetRGBA(pixel, format, &r, &g, &b, &a);
             }
             break;
@@ -82,15 +68,12 @@ Texture::Texture(const std::string& filename) {
             }
             break;
             default:
-                std::cerr << "Unsupported pixel format: " << static_cast<int>(format->BitsPerPixel) << " bits per pixel." << std::endl;
+                LOG_ERROR("Unsupported pixel format: " << static_cast<int>(format->BitsPerPixel) << " bits per pixel");
                 SDL_UnlockSurface(surface);
                 SDL_FreeSurface(surface);
                 return; // Desteklenmeyen format durumunda fonksiyondan k
             }
 
-            // Debug output to check pixel values
-            // std::cout << "Pixel (" << x << ", " << y << "): R=" << static_cast<int>(r) << ", G=" << static_cast<int>(g) << ", B=" << static_cast<int>(b) << ", A=" << static_cast<int>(a) << std::endl;
-
             float normalized_r = r / 255.0f;
             float normalized_g = g / 255.0f;
             float normalized_b = b / 255.0f;
@@ -108,6 +91,14 @@ Texture::Texture(const std::string& filename) {
 
     SDL_UnlockSurface(surface);
     SDL_FreeSurface(surface);
+    detect_constant();
+}
+
+void Texture::detect_constant() {
+    // glTF da aktarmlarnda sk grlen 1x1 ve tek renk dokular
+    m_is_constant = !pixels.empty() && std::all_of(pixels.begin(), pixels.end(), [this](const Vec3& p) {
+        return p.x == pixels[0].x && p.y == pixels[0].y && p.z == pixels[0].z;
+        });
 }
 
 float Texture::get_alpha(double u, double v) const {
@@ -136,17 +127,18 @@ float Texture::get_alpha(double u, double v) const {
 void Texture::loadOpacityMap(const std::string& filename) {
     SDL_Surface* surface = IMG_Load(filename.c_str());
     if (!surface) {
-        std::cerr << "Error loading opacity map: " << filename << ", SDL Error: " << IMG_GetError() << std::endl;
+        LOG_ERROR("Error loading opacity map: " << filename << ", SDL Error: " << IMG_GetError());
         return;
     }
 
     // Opacity map'in boyutlarn kontrol et ve gerekirse alphas vektrn yeniden boyutlandr
     if (surface->w != width || surface->h != height) {
-        std::cout << "Opacity map dimensions do not match the main texture. Resizing alpha channel." << std::endl;
+        LOG_WARN("Opacity map " << filename << " does not match the main texture size, resizing alpha channel");
         width = surface->w;
         height = surface->h;
         alphas.resize(width * height, 1.0f);  // Yeni boyuta gre alphas' yeniden boyutlandr ve 1.0f ile balat
     }
+    alphas.resize(width * height, 1.0f);  // RGB dokularda alfa kanal henz yok
 
     SDL_LockSurface(surface);
     Uint8* pixelData = static_cast<Uint8*>(surface->pixels);
@@ -172,7 +164,7 @@ void Texture::loadOpacityMap(const std::string& filename) {
                 alphas[index] = gray / 255.0f;
             }
             else {
-                std::cerr << "Error: Attempting to access out of bounds index in alphas vector." << std::endl;
+                LOG_ERROR("Out of bounds index in alphas vector");
                 SDL_UnlockSurface(surface);
                 SDL_FreeSurface(surface);
                 return;
@@ -183,7 +175,7 @@ void Texture::loadOpacityMap(const std::string& filename) {
     SDL_UnlockSurface(surface);
     SDL_FreeSurface(surface);
 
-    std::cout << "Opacity map loaded successfully. Dimensions: " << width << "x" << height << std::endl;
+    LOG_INFO("Opacity map loaded: " << filename << " (" << width << "x" << height << ")");
 }
 Vec3 Texture::get_color(double u, double v) const {
     // Snr kontrol
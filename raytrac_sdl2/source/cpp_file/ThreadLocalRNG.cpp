@@ -8,3 +8,8 @@ ThreadLocalRNG::ThreadLocalRNG()
  float ThreadLocalRNG::get() {
     return dis(gen);
 }
+
+ThreadLocalRNG& ThreadLocalRNG::instance() {
+    thread_local ThreadLocalRNG rng;
+    return rng;
+}
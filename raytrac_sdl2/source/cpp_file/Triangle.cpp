@@ -6,13 +6,15 @@
 #include <iostream>
 #include "globals.h"
 #include "PrincipledBSDF.h"
+#include "AlphaMask.h"
 #include <chrono>
 
 Triangle::Triangle()
     : smoothGroup(0) {}
 
 Triangle::Triangle(const Vec3SIMD& a, const Vec3SIMD& b, const Vec3SIMD& c, std::shared_ptr<Material> m)
-    : v0(a), v1(b), v2(c), material(m), smoothGroup(0) {
+    : v0(a), v1(b), v2(c), material_id(scene_materials.add(m)), smoothGroup(0) {
+    update_bounding_box();
     initialize_transforms();  // Transform ilemlerini balat
 }
 
@@ -23,7 +25,7 @@ Triangle::Triangle(const Vec3SIMD& a, const Vec3SIMD& b, const Vec3SIMD& c,
     : v0(a), v1(b), v2(c),
     n0(na), n1(nb), n2(nc),
     t0(ta), t1(tb), t2(tc),
-    material(m), smoothGroup(sg) {
+    material_id(scene_materials.add(m)), smoothGroup(sg) {
     update_bounding_box();
     initialize_transforms();  // Transform ilemlerini balat
 }
@@ -47,6 +49,7 @@ void Triangle::set_transform(const Matrix4x4& t) {
     transform = t;
 
     update_bounding_box();
+    initialize_transforms();
 }
 void Triangle::updateTriangleTransform(Triangle& triangle, const Matrix4x4& transform) {
     triangle.set_transform(transform);
@@ -98,8 +101,8 @@ Vec3SIMD Triangle::calculateBarycentricCoordinates(const Vec3SIMD& point) const
 
 // Eik deeri bir sabit olarak hesaplayn
 const double cos_threshold = std::cos(60.0 * M_PI / 180.0);
-bool Triangle::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
-    // Vertexleri dntrme
+// Mller-Trumbore; hit() ve occluded() ortak kullanr
+bool Triangle::intersect(const Ray& r, double t_min, double t_max, float& t, float& u, float& v) const {
     const Vec3SIMD edge1 = transformed_v1 - transformed_v0;
     const Vec3SIMD edge2 = transformed_v2 - transformed_v0;
 
@@ -113,22 +116,44 @@ bool Triangle::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) con
 
     float f = 1.0 / a;
     Vec3SIMD s = r.origin - transformed_v0;
-    float u = f * Vec3SIMD::dotfloat(s, h);
+    u = f * Vec3SIMD::dotfloat(s, h);
 
     if (u < 0.0 || u > 1.0)
         return false;
 
     Vec3SIMD q = Vec3SIMD::cross(s, edge1);
-    float v = f * Vec3SIMD::dotfloat(r.direction, q);
+    v = f * Vec3SIMD::dotfloat(r.direction, q);
 
     if (v < 0.0 || u + v > 1.0)
         return false;
 
-    float t = f * Vec3SIMD::dotfloat(edge2, q);
+    t = f * Vec3SIMD::dotfloat(edge2, q);
+
+    return t >= t_min && t <= t_max;
+}
+
+// Any-hit alfa testi: maskelenen noktada n yzeyden geer ve BVH aramaya devam eder
+bool Triangle::masked_out(float u, float v) const {
+    const AlphaMask* mask = scene_materials.compiled(material_id).alpha_mask;
+    if (!mask)
+        return false;
+    const float w = 1.0f - u - v;
+    return !mask->solid(static_cast<float>(w * t0.u + u * t1.u + v * t2.u),
+        static_cast<float>(w * t0.v + u * t1.v + v * t2.v));
+}
+
+bool Triangle::occluded(const Ray& r, double t_min, double t_max) const {
+    float t, u, v;
+    return intersect(r, t_min, t_max, t, u, v) && !masked_out(u, v);
+}
 
-    if (t < t_min || t > t_max)
+bool Triangle::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
+    float t, u, v;
+    if (!intersect(r, t_min, t_max, t, u, v) || masked_out(u, v))
         return false;
 
+    const Vec3SIMD edge1 = transformed_v1 - transformed_v0;
+    const Vec3SIMD edge2 = transformed_v2 - transformed_v0;
     rec.t = t;
     rec.point = r.at(t);
     const float w = 1.0 - u - v;
@@ -155,7 +180,8 @@ bool Triangle::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) con
     rec.uv = uv;
     rec.u = uv.u;
     rec.v = uv.v;
-    rec.material = material;
+    rec.material_id = material_id;
+    rec.light_index = light_index;
 
     return true;
 }
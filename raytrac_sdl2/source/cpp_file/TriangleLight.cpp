@@ -0,0 +1,60 @@
+#include "TriangleLight.h"
+#include "Triangle.h"
+#include "MaterialTable.h"
+#include <cmath>
+
+TriangleLight::TriangleLight(const Vec3SIMD& a, const Vec3SIMD& b, const Vec3SIMD& c, const Vec3SIMD& radiance)
+    : vertices{ a, b, c }, radiance(radiance) {
+    Vec3SIMD n = Vec3SIMD::cross(b - a, c - a);
+    float twice_area = n.length();
+    area = 0.5f * twice_area;
+    normal = twice_area > 0.0f ? n / twice_area : Vec3SIMD(0, 1, 0);
+    position = (a + b + c) / 3.0f;
+    direction = normal;
+    intensity = radiance * area;
+}
+
+Vec3SIMD TriangleLight::getDirection(const Vec3SIMD& point) const {
+    return (position - point).normalize();
+}
+
+Vec3SIMD TriangleLight::getIntensity(const Vec3SIMD& point) const {
+    // Both faces emit, as with AreaLight
+    Vec3SIMD to_point = point - position;
+    float d2 = to_point.length_squared();
+    if (d2 <= 0.0f)
+        return Vec3SIMD(0, 0, 0);
+    float cos_l = std::abs(normal.dot(to_point)) / std::sqrt(d2);
+    return intensity * (cos_l / d2);
+}
+
+Vec3SIMD TriangleLight::random_point() const {
+    float su = std::sqrt(static_cast<float>(Vec3SIMD::random_double()));
+    float v = static_cast<float>(Vec3SIMD::random_double());
+    return vertices[0] + (vertices[1] - vertices[0]) * (su * (1.0f - v)) + (vertices[2] - vertices[0]) * (su * v);
+}
+
+size_t TriangleLight::collect(const std::vector<std::shared_ptr<Hittable>>& objects, std::vector<std::shared_ptr<Light>>& lights) {
+    size_t added = 0;
+    for (const auto& object : objects) {
+        auto triangle = std::dynamic_pointer_cast<Triangle>(object);
+        if (!triangle)
+            continue;
+        triangle->light_index = -1;
+        // Light samples and BSDF hits are MIS weighted against each other, so
+        // both must see the same radiance everywhere on the triangle. Only
+        // uniform emitters qualify; textured ones are found by BSDF rays alone.
+        const CompiledMaterial& material = scene_materials.compiled(triangle->material_id);
+        if (!material.material || !material.emissive || !material.uniform_emission)
+            continue;
+
+        auto light = std::make_shared<TriangleLight>(triangle->transformed_v0, triangle->transformed_v1,
+            triangle->transformed_v2, material.emission);
+        if (light->getArea() <= 0.0f)
+            continue;
+        triangle->light_index = static_cast<int>(lights.size());
+        lights.push_back(light);
+        ++added;
+    }
+    return added;
+}
@@ -0,0 +1,40 @@
+#include "UVTransform.h"
+
+UVTransform UVTransform::bake(const Vec2& scale, double rotation_degrees, const Vec2& translation,
+    const Vec2& tiling, WrapMode wrap) {
+    UVTransform t;
+    t.wrap = wrap;
+    if (wrap == WrapMode::Planar)
+        return t;
+
+    // tiling * (R * S * (uv - 0.5) + 0.5 + translation), folded into one matrix
+    const double radians = rotation_degrees * M_PI / 180.0;
+    const double cos_r = std::cos(radians);
+    const double sin_r = std::sin(radians);
+    const double a = cos_r * scale.u, b = -sin_r * scale.v;
+    const double d = sin_r * scale.u, e = cos_r * scale.v;
+    t.a = static_cast<float>(tiling.u * a);
+    t.b = static_cast<float>(tiling.u * b);
+    t.c = static_cast<float>(tiling.u * (0.5 + translation.u - 0.5 * (a + b)));
+    t.d = static_cast<float>(tiling.v * d);
+    t.e = static_cast<float>(tiling.v * e);
+    t.f = static_cast<float>(tiling.v * (0.5 + translation.v - 0.5 * (d + e)));
+    return t;
+}
+
+Vec2 UVTransform::cubic(float u, float v) {
+    // Six faces laid out on a 3 x 2 atlas
+    const float u_scaled = u * 3.0f;
+    const float v_scaled = v * 3.0f;
+    const int face = static_cast<int>(u_scaled) + 3 * static_cast<int>(v_scaled);
+    const float u_local = std::fmod(u_scaled, 1.0f);
+    const float v_local = std::fmod(v_scaled, 1.0f);
+
+    switch (face % 6) {
+    case 1: return Vec2(v_local, 1.0f - u_local);
+    case 2: return Vec2(1.0f - u_local, v_local);
+    case 3: return Vec2(1.0f - v_local, 1.0f - u_local);
+    case 4: return Vec2(u_local, 1.0f - v_local);
+    default: return Vec2(u_local, v_local);
+    }
+}
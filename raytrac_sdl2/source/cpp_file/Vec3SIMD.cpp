@@ -98,11 +98,8 @@ float Vec3SIMD::length_squared() const {
 }
 
 Vec3SIMD Vec3SIMD::cross(const Vec3SIMD& v) const {
-    __m256 a = _mm256_permute_ps(data, _MM_SHUFFLE(3, 0, 2, 1));
-    __m256 b = _mm256_permute_ps(v.data, _MM_SHUFFLE(3, 0, 2, 1));
-    __m256 c = _mm256_mul_ps(a, v.data);
-    __m256 d = _mm256_mul_ps(b, data);
-    return Vec3SIMD(_mm256_sub_ps(c, d));
+    // ki permtasyonlu eski hali (-z, -x, -y) dndryordu; statik srmle ayn olmal
+    return cross(*this, v);
 }
 
 Vec3SIMD Vec3SIMD::safe_normalize(const Vec3SIMD& fallback) const {
@@ -0,0 +1,259 @@
+#include "WavefrontIntegrator.h"
+#include "MaterialDispatch.h"
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace {
+    // Material type in the top byte, then the material id, then the path, so a
+    // plain sort bins the hits by type and id and keeps pixel order inside a bin.
+    constexpr int path_bits = 24;
+    constexpr uint64_t path_mask = (uint64_t(1) << path_bits) - 1;
+
+    inline uint64_t shade_key(MaterialType type, uint32_t material_id, uint32_t path) {
+        return (uint64_t(static_cast<uint8_t>(type)) << 56) | (uint64_t(material_id) << path_bits) | path;
+    }
+}
+
+void WavefrontIntegrator::render_rows(Renderer& renderer, const ParallelBVHNode* bvh, const Vec3SIMD& background_color,
+    int start_row, int end_row, int samples_per_pixel,
+    const std::function<void(int, int, const PixelSums&)>& emit) {
+    samples_per_pixel = std::max(samples_per_pixel, 1);
+    const size_t pixels_per_wave = std::max<size_t>(1, wave_size / samples_per_pixel);
+    pixel_x.clear();
+    pixel_y.clear();
+    for (int j = end_row; j >= start_row; --j) {
+        for (int i = 0; i < renderer.image_width; ++i) {
+            pixel_x.push_back(i);
+            pixel_y.push_back(j);
+            if (pixel_x.size() == pixels_per_wave) {
+                run_wave(renderer, bvh, background_color, samples_per_pixel, emit);
+                pixel_x.clear();
+                pixel_y.clear();
+            }
+        }
+    }
+    if (!pixel_x.empty())
+        run_wave(renderer, bvh, background_color, samples_per_pixel, emit);
+}
+
+void WavefrontIntegrator::run_wave(Renderer& renderer, const ParallelBVHNode* bvh, const Vec3SIMD& background_color,
+    int samples_per_pixel, const std::function<void(int, int, const PixelSums&)>& emit) {
+    const size_t count = pixel_x.size() * samples_per_pixel;
+    origin.resize(count);
+    direction.resize(count);
+    throughput.assign(count, Vec3SIMD(1, 1, 1));
+    radiance.assign(count, Vec3SIMD(0, 0, 0));
+    prev_point.assign(count, Vec3SIMD(0, 0, 0));
+    prev_bsdf_pdf.assign(count, 0.0f);
+    prev_specular.assign(count, 1);
+    total_distance.assign(count, 0.0f);
+    hits.resize(count);
+    aov_albedo.assign(count, Vec3SIMD(0, 0, 0));
+    aov_normal.assign(count, Vec3SIMD(0, 0, 0));
+    aov_ao.assign(count, 1.0f);
+
+    // Camera rays, in the order render_chunk draws its samples
+    active.clear();
+    for (size_t k = 0; k < pixel_x.size(); ++k) {
+        for (int s = 0; s < samples_per_pixel; ++s) {
+            const uint32_t path = static_cast<uint32_t>(k * samples_per_pixel + s);
+            Vec2 uv = renderer.stratified_halton(pixel_x[k], pixel_y[k], 0, samples_per_pixel);
+            Ray r = renderer.camera.get_ray(uv.u, uv.v);
+            origin[path] = r.origin;
+            direction[path] = r.direction;
+            active.push_back(path);
+        }
+    }
+    counters.paths += count;
+
+    const int max_depth = renderer.path_max_depth();
+    for (int bounce = 0; bounce < max_depth && !active.empty(); ++bounce) {
+        extend(renderer, bvh, background_color, bounce);
+        shade(renderer, bvh, bounce);
+        trace_shadows(renderer, bvh);
+        active.swap(next_active);
+    }
+
+    for (size_t k = 0; k < pixel_x.size(); ++k) {
+        PixelSums sums;
+        for (int s = 0; s < samples_per_pixel; ++s) {
+            const size_t path = k * samples_per_pixel + s;
+            PathAOV aov;
+            aov.albedo = aov_albedo[path];
+            aov.normal = aov_normal[path];
+            aov.ao = aov_ao[path];
+            sums.add(radiance[path], aov);
+        }
+        emit(pixel_x[k], pixel_y[k], sums);
+    }
+}
+
+void WavefrontIntegrator::extend(Renderer& renderer, const ParallelBVHNode* bvh, const Vec3SIMD& background_color, int bounce) {
+    shade_keys.clear();
+    for (uint32_t path : active) {
+        Vec3SIMD& tp = throughput[path];
+        if (!renderer.continue_path(bounce, tp))
+            continue;
+
+        ++counters.extension_rays;
+        const Ray ray(origin[path], direction[path]);
+        HitRecord& rec = hits[path];
+        rec = HitRecord();
+        const bool hit_surface = bvh->hit(ray, EPSILON, std::numeric_limits<double>::infinity(), rec);
+
+        // Area lights are not in the BVH; a ray that reaches one first ends there
+        int area_index = -1;
+        float area_t = 0.0f;
+        const float surface_t = hit_surface ? static_cast<float>(rec.t) : std::numeric_limits<float>::infinity();
+        if (renderer.light_sampler && renderer.light_table.intersect(ray, surface_t, area_index, area_t)) {
+            float weight = 1.0f;
+            if (bounce > 0 && !prev_specular[path])
+                weight = renderer.emission_mis_weight(area_index, ray, area_t, prev_point[path], prev_bsdf_pdf[path]);
+            radiance[path] += tp * renderer.light_table.radiance(area_index) * weight;
+            continue;
+        }
+
+        if (!hit_surface) {
+            const EnvironmentLight* environment = renderer.light_table.environment;
+            Vec3SIMD sky_color = environment ? environment->radiance(ray.direction) : background_color;
+            float weight = 1.0f;
+            if (environment && renderer.light_sampler && bounce > 0 && !prev_specular[path])
+                weight = renderer.emission_mis_weight(renderer.light_table.environment_index, ray,
+                    std::numeric_limits<float>::infinity(), prev_point[path], prev_bsdf_pdf[path]);
+            if (bounce == 0)
+                aov_albedo[path] = sky_color;
+            if (renderer.atmosphericEffects.active())
+                sky_color = renderer.atmosphericEffects.applyAtmosphericEffects(sky_color, total_distance[path]);
+            radiance[path] += tp * sky_color * weight;
+            continue;
+        }
+
+        shade_keys.push_back(shade_key(scene_materials.compiled(rec.material_id).type, rec.material_id, path));
+    }
+    if (sort_by_material)
+        std::sort(shade_keys.begin(), shade_keys.end());
+}
+
+void WavefrontIntegrator::shade(Renderer& renderer, const ParallelBVHNode* bvh, int bounce) {
+    next_active.clear();
+    shadow_origin.clear();
+    shadow_direction.clear();
+    shadow_contribution.clear();
+    shadow_t_max.clear();
+    shadow_path.clear();
+    shadow_sun.clear();
+
+    uint32_t previous_material = MaterialTable::none;
+    for (uint64_t key : shade_keys) {
+        const uint32_t path = static_cast<uint32_t>(key & path_mask);
+        HitRecord& rec = hits[path];
+        const CompiledMaterial& material = scene_materials.compiled(rec.material_id);
+        counters.material_switches += previous_material != MaterialTable::none && rec.material_id != previous_material;
+        previous_material = rec.material_id;
+        ++counters.vertices;
+
+        const Ray ray(origin[path], direction[path]);
+        Vec3SIMD& tp = throughput[path];
+        const Vec3SIMD transformed_normal = Renderer::apply_normal_map(rec, material);
+        rec.normal = transformed_normal;
+        if (bounce == 0) {
+            aov_albedo[path] = material.material->get_albedo(rec.u, rec.v);
+            aov_normal[path] = transformed_normal;
+            if (renderer.settings.ao_samples > 0)
+                aov_ao[path] = renderer.ambient_occlusion(bvh, rec.point, transformed_normal);
+        }
+
+        const float segment_start = total_distance[path];
+        total_distance[path] += static_cast<float>(rec.t);
+        if (renderer.atmosphericEffects.active()) {
+            tp = renderer.atmosphericEffects.attenuateSegment(tp, segment_start, total_distance[path]);
+            radiance[path] += tp * renderer.atmosphericEffects.calculateSegmentContribution(segment_start, total_distance[path]);
+        }
+
+        Vec3SIMD emitted = MaterialDispatch::emitted(material, rec);
+        if (emitted.max_component() > 0.0f) {
+            float weight = 1.0f;
+            if (rec.light_index >= 0 && renderer.light_sampler && bounce > 0 && !prev_specular[path])
+                weight = renderer.emission_mis_weight(rec.light_index, ray, static_cast<float>(rec.t), prev_point[path], prev_bsdf_pdf[path]);
+            radiance[path] += tp * emitted * weight;
+        }
+
+        Vec3SIMD attenuation;
+        Ray scattered;
+        float scatter_pdf = 0.0f;
+        if (!MaterialDispatch::sample(material, ray, rec, attenuation, scattered, scatter_pdf))
+            continue;
+
+        if (material.type == MaterialType::Dielectric) {
+            tp *= attenuation;
+            prev_point[path] = rec.point;
+            prev_specular[path] = 1;
+        }
+        else {
+            if (!material.specular) {
+                ShadowRay shadows[Renderer::max_shadow_rays];
+                const int count = renderer.prepare_direct_lighting(rec, -ray.direction.normalize(), shadows);
+                for (int s = 0; s < count; ++s) {
+                    shadow_origin.push_back(shadows[s].ray.origin);
+                    shadow_direction.push_back(shadows[s].ray.direction);
+                    shadow_contribution.push_back(tp * shadows[s].contribution);
+                    shadow_t_max.push_back(shadows[s].t_max);
+                    shadow_path.push_back(path);
+                    shadow_sun.push_back(shadows[s].sun);
+                }
+            }
+
+            prev_point[path] = rec.point;
+            prev_specular[path] = material.specular;
+            prev_bsdf_pdf[path] = material.specular ? 0.0f : scatter_pdf;
+
+            const float scattering_attenuation = 1.0f / (1.0f + total_distance[path] * material.scattering_factor);
+            tp *= attenuation * scattering_attenuation;
+        }
+
+        origin[path] = scattered.origin;
+        direction[path] = scattered.direction;
+        next_active.push_back(path);
+    }
+}
+
+void WavefrontIntegrator::trace_shadows(const Renderer& renderer, const ParallelBVHNode* bvh) {
+    counters.shadow_rays += shadow_path.size();
+
+    // Rays of different paths share nothing but the scene, and a packet of them
+    // visits the union of their BVH nodes; only an area-light group, which
+    // starts from one shading point, is traced as a packet.
+    Ray rays[Renderer::max_shadow_rays];
+    float t_max[Renderer::max_shadow_rays];
+    const uint32_t queued = static_cast<uint32_t>(shadow_path.size());
+    for (uint32_t q = 0; q < queued;) {
+        const uint32_t path = shadow_path[q];
+        if (shadow_sun[q]) {
+            // Same answer as the BVH, usually without touching it
+            if (!renderer.sun_cache.occluded(shadow_origin[q], shadow_direction[q], 0.01f, bvh))
+                radiance[path] += shadow_contribution[q];
+            ++q;
+            continue;
+        }
+        uint32_t end = q + 1;
+        while (end < queued && shadow_path[end] == path)
+            ++end;
+        const int count = static_cast<int>(end - q);
+        if (count == 1) {
+            if (!bvh->occluded(Ray(shadow_origin[q], shadow_direction[q]), 0.01f, shadow_t_max[q]))
+                radiance[path] += shadow_contribution[q];
+        }
+        else {
+            for (int s = 0; s < count; ++s) {
+                rays[s] = Ray(shadow_origin[q + s], shadow_direction[q + s]);
+                t_max[s] = shadow_t_max[q + s];
+            }
+            const uint32_t active = (1u << count) - 1;
+            const uint32_t visible = active & ~bvh->occluded_packet(rays, t_max, active, 0.01);
+            for (uint32_t bits = visible; bits; bits &= bits - 1)
+                radiance[path] += shadow_contribution[q + std::countr_zero(bits)];
+        }
+        q = end;
+    }
+}
@@ -12,3 +12,4 @@ const double EPSILON = 1e-6f;
 const int MAX_DEPTH = 10;
 std::atomic<int> next_row(0);
 const double infinity = std::numeric_limits<double>::max();
+const size_t light_tree_min_lights = 16;  // bu saydan itibaren k aac kullanlr
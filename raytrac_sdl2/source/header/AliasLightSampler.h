@@ -0,0 +1,23 @@
+#ifndef ALIAS_LIGHT_SAMPLER_H
+#define ALIAS_LIGHT_SAMPLER_H
+
+#include "LightSampler.h"
+
+// Power-proportional light selection through Vose's alias table: O(n) build,
+// O(1) sample with a single random number. The shading point is ignored.
+class AliasLightSampler : public LightSampler {
+public:
+    void build(const std::vector<std::shared_ptr<Light>>& lights, float scene_radius) override;
+    int sample(float u, const Vec3SIMD& point, float& pdf) const override;
+    float pdf(int light_index, const Vec3SIMD& point) const override;
+
+private:
+    struct Bin {
+        float probability;   // chance of keeping this bin's own light
+        int alias;           // light taken otherwise
+    };
+    std::vector<Bin> bins;
+    std::vector<float> pdfs;
+};
+
+#endif // ALIAS_LIGHT_SAMPLER_H
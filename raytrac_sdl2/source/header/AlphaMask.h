@@ -0,0 +1,54 @@
+#ifndef ALPHA_MASK_H
+#define ALPHA_MASK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "UVTransform.h"
+
+class Texture;
+
+// An opacity texture reduced to one bit per texel at a fixed cutoff, for the
+// alpha test that triangles run during traversal. A cut-out hit is rejected
+// inside the BVH walk, so leaves and grates no longer cost a material lookup,
+// a texture read and a scatter call per transparent texel, and shadow rays
+// pass through them as well. Lookups pick the nearest texel the same way
+// Texture::get_alpha does.
+class AlphaMask {
+public:
+    // Opacity is the alpha channel when alpha_only is set, as for a diffuse
+    // texture whose alpha doubles as the cutout; otherwise the mean of the
+    // colour channels times the alpha. Both are scaled by intensity. Returns
+    // nullptr when every texel is solid, since such a mask never rejects a hit.
+    static std::shared_ptr<AlphaMask> build(const Texture& texture, bool alpha_only, float intensity,
+        const UVTransform* transform, float cutoff = 0.5f);
+
+    // Mesh uv in, transformed like the material's texture reads
+    bool solid(float u, float v) const {
+        if (transformed) {
+            const Vec2 t = transform.apply(u, v);
+            u = static_cast<float>(t.u);
+            v = static_cast<float>(t.v);
+        }
+        u = std::clamp(u, 0.0f, 1.0f);
+        v = std::clamp(v, 0.0f, 1.0f);
+        const int x = static_cast<int>(u * (width - 1));
+        const int y = static_cast<int>((1.0f - v) * (height - 1));
+        const size_t index = static_cast<size_t>(y) * width + x;
+        return (bits[index >> 6] >> (index & 63)) & 1;
+    }
+
+    size_t solid_texels() const { return solid_count; }
+    size_t texels() const { return static_cast<size_t>(width) * height; }
+
+private:
+    int width = 0;
+    int height = 0;
+    std::vector<uint64_t> bits;
+    UVTransform transform;
+    bool transformed = false;
+    size_t solid_count = 0;
+};
+
+#endif // ALPHA_MASK_H
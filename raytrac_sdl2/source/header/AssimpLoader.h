@@ -495,9 +495,9 @@ private:
             std::string textureName = sanitizeTextureName(str);
             std::shared_ptr<Texture> diffuseTexture = loadTexture(textureName.c_str());
             material->albedoProperty.texture = diffuseTexture;
-            // Diffuse texture'n alfa kanaln opacity olarak kullan
-            material->opacityProperty.texture = diffuseTexture;
-            material->setOpacityTexture(diffuseTexture, 1);
+            // Diffuse texture'n alfa kanal varsa onu opacity olarak kullan
+            if (diffuseTexture && diffuseTexture->has_alpha())
+                material->setOpacityTexture(diffuseTexture, 1);
         }
 
         // Ayr bir opacity texture varsa, onu da ykle
@@ -506,14 +506,16 @@ private:
             aiMat->GetTexture(aiTextureType_OPACITY, 0, &str);
             std::string textureName = sanitizeTextureName(str);
             std::shared_ptr<Texture> opacityTexture = loadTexture(textureName.c_str());
-            material->opacityProperty.texture = opacityTexture;
             material->setOpacityTexture(opacityTexture, 1);
         }
 
-        // Opacity (transparency)
+        // Opacity (transparency); sabit deer dokuyu silmez, dokunun younluu olur
         float opacity = 1.0f;
         aiMat->Get(AI_MATKEY_OPACITY, opacity);
-        material->opacityProperty = MaterialProperty(opacity);
+        if (material->opacityProperty.texture)
+            material->opacityProperty.intensity = opacity;
+        else
+            material->opacityProperty = MaterialProperty(Vec3(opacity));
      
         aiString materialName;
         aiMat->Get(AI_MATKEY_NAME, materialName);
@@ -3,6 +3,7 @@
 #include "Texture.h"
 #include <string>
 #include <optional>
+#include <vector>
 
 class AtmosphericEffects {
 private:
@@ -18,9 +19,29 @@ private:
     Vec3 background_color;
     //bool use_background_texture;
 
+    // Fog and haze factors and light transmittance tabulated over distance.
+    // Every setter rebuilds them, so shading only does a table fetch.
+    static constexpr int lut_size = 1024;
+    bool has_medium = false;
+    float lut_range = 1.0f;
+    float lut_inv_step = 0.0f;
+    std::vector<float> fog_lut;
+    std::vector<float> haze_lut;
+    std::vector<float> transmittance_lut;
+    Vec3SIMD fog_segment_color;       // texture centre or fog_color
+    Vec3SIMD haze_segment_color;
+    void compile();
+    float lookup(const std::vector<float>& table, float distance) const;
+    float fogAt(float distance) const;
+    float hazeAt(float distance) const;
+
 public:
     bool use_background_texture;
     bool enable = true;
+    // False when disabled or every density is zero; callers skip the effect then.
+    bool active() const { return enable && has_medium; }
+    // exp(-optical depth) of fog and haze along distance, for light attenuation
+    float lightTransmittance(float distance) const;
     Vec3SIMD attenuateSegment(const Vec3SIMD& color, float start_distance, float end_distance) const;
     Vec3SIMD calculateSegmentContribution(float start_distance, float end_distance) const;
 
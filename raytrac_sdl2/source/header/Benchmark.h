@@ -0,0 +1,36 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include "RenderSettings.h"
+
+// Micro benchmarks selected with --bench <name>. They build synthetic
+// scenes, print their timings to std::cout and return the exit code.
+class Benchmark {
+public:
+    static int run(const RenderSettings& settings);
+
+private:
+    // Cost of one direct-lighting estimate as the light count grows, and the
+    // per-light dispatch cost of the flat light table against RTTI casts.
+    static int direct_lighting(const RenderSettings& settings);
+    // Sun shadow rays answered by SunVisibilityCache against the full BVH
+    // trace: agreement, how each query was resolved, and ns per ray.
+    static int sun_cache(const RenderSettings& settings);
+    // Per-vertex BSDF cost on a mixed material set: the old scatter + pdf and
+    // eval + pdf call pattern against sample() and the combined eval/pdf,
+    // through the vtable and through the MaterialDispatch switch.
+    static int scatter(const RenderSettings& settings);
+    // Samples per second of ray_color against WavefrontIntegrator, with and
+    // without the material sort, on boxes cycling through five materials.
+    // The switch rate is the coherence proxy; for hardware cache misses run
+    // this mode under a profiler (perf stat, VTune).
+    static int wavefront(const RenderSettings& settings);
+    // Path termination policies on a closed, bright interior where most light
+    // is indirect: rays traced per sample, per-sample variance, and the rays
+    // per pixel and time each policy needs to match the variance of the
+    // roulette-free reference.
+    static int roulette(const RenderSettings& settings);
+};
+
+#endif // BENCHMARK_H
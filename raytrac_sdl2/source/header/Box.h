@@ -9,7 +9,7 @@ class Box : public Hittable {
 public:
     Vec3 center;
     double size;
-    std::shared_ptr<Material> material;
+    uint32_t material_id;
 
     Box();
     Box(const Vec3& position, double size, std::shared_ptr<Material> mat);
@@ -0,0 +1,52 @@
+#ifndef DENOISER_H
+#define DENOISER_H
+
+#include <vector>
+#include <OpenImageDenoise/oidn.hpp>
+
+// Owns the OIDN device, the RT filter and its buffers for the lifetime of
+// the renderer. The device is created (and CUDA probed) once; the filter and
+// buffers are rebuilt only when the resolution changes.
+class Denoiser {
+public:
+    Denoiser() = default;
+
+    // Returns false if no OIDN device could be created.
+    bool prepare(int width, int height, int num_threads = 0);
+
+    // color: linear HDR RGB floats, width * height * 3, row order of the surface.
+    // albedo/normal: first-hit auxiliary images of the same layout (albedo in
+    // [0,1]). They are averaged over all samples and treated as noise-free.
+    // The filtered image is available through output() afterwards.
+    bool denoise(const float* color, const float* albedo, const float* normal);
+    const float* output() const { return host_output.data(); }
+
+    // Preview scheduling: an intermediate denoise is allowed when its expected
+    // cost stays within budget_fraction of the render time since the last one.
+    bool within_budget(double seconds_since_last, float budget_fraction) const;
+
+    double last_seconds() const { return last_duration; }
+    double total_seconds() const { return total_duration; }
+    int width() const { return buffer_width; }
+    int height() const { return buffer_height; }
+
+private:
+    bool create_device(int num_threads);
+
+    oidn::DeviceRef device;
+    oidn::FilterRef filter;
+    oidn::BufferRef color_buffer;
+    oidn::BufferRef albedo_buffer;
+    oidn::BufferRef normal_buffer;
+    oidn::BufferRef output_buffer;
+    std::vector<float> host_output;
+
+    bool device_ready = false;
+    bool device_failed = false;
+    int buffer_width = 0;
+    int buffer_height = 0;
+    double last_duration = 0.0;
+    double total_duration = 0.0;
+};
+
+#endif // DENOISER_H
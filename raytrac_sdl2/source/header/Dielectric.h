@@ -6,6 +6,7 @@
 class Dielectric : public Material {
 public:
     MaterialType type() const override { return MaterialType::Dielectric; }
+    bool is_specular() const override { return true; }
     Dielectric(double index_of_refraction,
         const Vec3SIMD& color = Vec3SIMD(0.95, 0.95, 1.0),
         double caustic_intensity = 0.1,
@@ -23,6 +24,7 @@ public:
     float get_scattering_factor() const override {
         return 0.001f; // Example value
     }
+    Vec3 get_albedo(double u, double v) const override { return color; }
     Vec3SIMD color; // Base color of the glass
     double caustic_intensity; // Intensity of the caustic effect
     float thickness; // Thickness of the glass
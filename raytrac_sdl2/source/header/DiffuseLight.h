@@ -1,18 +1,12 @@
 #ifndef DIFFUSELIGHT_H
 #define DIFFUSELIGHT_H
 
-#include "Material.h"
+#include "EmissiveMaterial.h"
 
-class DiffuseLight : public Material {
+// Older name of EmissiveMaterial, kept for existing scenes and code.
+class DiffuseLight : public EmissiveMaterial {
 public:
     DiffuseLight(Vec3SIMD c);
-   
-    virtual bool scatter(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered) const override;
-
-    virtual Vec3SIMD emitted(double u, double v, const Vec3SIMD& p) const override;
-   
-public:
-    Vec3 emit;
 };
 
 #endif // DIFFUSELIGHT_H
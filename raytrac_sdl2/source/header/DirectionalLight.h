@@ -21,6 +21,7 @@ public:
         return position; 
     }
     Vec3SIMD random_point() const override;
+    double getRadius() const { return disk_radius; }
     LightType type() const override;
     void setPosition(const Vec3SIMD& pos) {
         position = pos;
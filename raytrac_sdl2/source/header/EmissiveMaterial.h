@@ -3,13 +3,22 @@
 
 #include "Material.h"
 
+// Surface that only emits a constant radiance; paths end on it.
 class EmissiveMaterial : public Material {
 public:
     EmissiveMaterial(const Vec3& emit);
 
+    MaterialType type() const override { return MaterialType::Emissive; }
     virtual bool scatter(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered) const override;
+    virtual bool sample(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered, float& pdf) const override;
+    virtual Vec3SIMD eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi, float& pdf) const override;
 
     virtual Vec3SIMD emitted(double u, double v, const Vec3SIMD& p) const override;
+    virtual Vec3 getEmission() const override { return emission; }
+    virtual Vec3 get_albedo(double u, double v) const override { return Vec3(0, 0, 0); }
+
+    double getIndexOfRefraction() const override { return 1.0; }
+    float get_scattering_factor() const override { return 0.0f; }
 
 private:
     Vec3SIMD emission;
@@ -0,0 +1,48 @@
+#ifndef ENVIRONMENT_LIGHT_H
+#define ENVIRONMENT_LIGHT_H
+
+#include <memory>
+#include <vector>
+#include "Light.h"
+#include "Texture.h"
+
+// The equirectangular background seen as a light. A piecewise-constant
+// distribution over the texture cells (luminance * cos(elevation), i.e. the
+// solid angle each row covers) is built once; sample() picks a row from the
+// marginal CDF and a column from that row's conditional CDF by binary search.
+//
+// radiance() uses the same (u, v) mapping the renderer has always used for
+// background lookups, so misses and light samples agree.
+class EnvironmentLight : public Light {
+public:
+    explicit EnvironmentLight(std::shared_ptr<Texture> texture);
+
+    Vec3SIMD getDirection(const Vec3SIMD& point) const override;
+    Vec3SIMD getIntensity(const Vec3SIMD& point) const override;
+    Vec3SIMD random_point() const override;
+    LightType type() const override { return LightType::Environment; }
+
+    bool valid() const { return total > 0.0f; }
+    Vec3SIMD radiance(const Vec3SIMD& direction) const;
+    // Solid angle density of sample() for a normalized direction.
+    float pdf(const Vec3SIMD& direction) const;
+    // Returns a normalized direction and its solid angle density.
+    bool sample(float u1, float u2, Vec3SIMD& direction, float& pdf) const;
+    // Mean luminance over the sphere, for power based light selection.
+    float average_luminance() const { return mean_luminance; }
+
+private:
+    void direction_to_uv(const Vec3SIMD& direction, float& u, float& s) const;
+    float pdf_uv(int x, int y, float s) const;
+
+    std::shared_ptr<Texture> texture;
+    int cols = 0;                      // cells the nearest lookup can reach
+    int rows = 0;
+    std::vector<float> func;           // rows * cols, luminance * cos(elevation)
+    std::vector<float> conditional;    // rows * (cols + 1), per row CDF
+    std::vector<float> marginal;       // rows + 1
+    float total = 0.0f;                // mean of func
+    float mean_luminance = 0.0f;
+};
+
+#endif // ENVIRONMENT_LIGHT_H
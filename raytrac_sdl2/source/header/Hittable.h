@@ -4,8 +4,10 @@
 #include "Ray.h"
 #include "AABB.h"
 #include <vector>
+#include <cstdint>
 #include <memory> // std::shared_ptr kullanm iin
 #include "Vec2.h"
+#include "MaterialTable.h"
 
 class Material; // leri bildirim
 class Texture;
@@ -18,7 +20,7 @@ struct HitRecord {
     Vec3SIMD interpolated_normal;
     Vec3SIMD face_normal;
     int smoothGroup;
-    std::shared_ptr<Material>  material;
+    uint32_t material_id = MaterialTable::none; // scene_materials iindeki yeri
     double t;
     double u;
     double v;
@@ -29,6 +31,9 @@ struct HitRecord {
     
     Vec2 globalUV; // Tm obje iin global UV koordinatlar
     bool hasGlobalUV = false; // Global UV'nin set edilip edilmediini kontrol etmek iin
+    int light_index = -1;     // Yayan genin k listesindeki yeri, yoksa -1
+
+    Material* material() const { return scene_materials.get(material_id); }
 
     inline void set_face_normal(const Ray& r, const Vec3& outward_normal) {
         front_face = Vec3::dot(r.direction, outward_normal) < 0;
@@ -41,9 +46,26 @@ public:
     virtual bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const = 0;
 
     virtual bool bounding_box(double time0, double time1, AABB& output_box) const = 0;
+
+    // Glge nlar iin any-hit: (t_min, t_max) aralnda bir ey varsa true.
+    // Varsaylan hit()'e der; alt snflar HitRecord doldurmadan cevap verebilir.
+    virtual bool occluded(const Ray& r, double t_min, double t_max) const {
+        HitRecord rec;
+        return hit(r, t_min, t_max, rec);
+    }
+    // En fazla 32 nlk paket: active'in i. biti rays[i]'yi seer.
+    // Dn, active iinden engellenen nlarn maskesidir.
+    virtual uint32_t occluded_packet(const Ray* rays, const float* t_max, uint32_t active, double t_min) const {
+        uint32_t blocked = 0;
+        for (int i = 0; i < 32; ++i) {
+            if ((active >> i & 1u) && occluded(rays[i], t_min, t_max[i]))
+                blocked |= 1u << i;
+        }
+        return blocked;
+    }
     virtual ~Hittable() = default;
     virtual void collect_neighbor_normals(const AABB& query_box, Vec3SIMD& neighbor_normal,
-        int& neighbor_count, const std::shared_ptr<Material>& current_material) const {
+        int& neighbor_count, uint32_t current_material_id) const {
         // Varsaylan implementasyon: hibir ey yapma
     }
     std::vector<std::shared_ptr<Hittable>> objects; // objects yesi eklendi
@@ -7,7 +7,9 @@ enum class LightType {
     Point,
     Directional,
     Spot,
-    Area
+    Area,
+    Triangle,   // Yayan mesh geni (TriangleLight)
+    Environment // Arka plan dokusu (EnvironmentLight)
 };
 
 class Light {
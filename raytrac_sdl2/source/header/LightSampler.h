@@ -0,0 +1,30 @@
+#ifndef LIGHT_SAMPLER_H
+#define LIGHT_SAMPLER_H
+
+#include <vector>
+#include <memory>
+#include "Light.h"
+#include "Vec3SIMD.h"
+
+// Picks one light per shading sample. Implementations return the chosen
+// index together with its selection probability so the estimate stays
+// unbiased: contribution / pdf.
+class LightSampler {
+public:
+    virtual ~LightSampler() = default;
+
+    // scene_radius bounds the geometry. Samplers that weigh every light by
+    // power() give directional and environment lights the power they deliver
+    // to a disk of that radius; LightTree ignores it and gives unbounded
+    // lights a fixed share instead.
+    virtual void build(const std::vector<std::shared_ptr<Light>>& lights, float scene_radius) = 0;
+
+    // u in [0,1). Returns -1 if there is nothing to sample.
+    virtual int sample(float u, const Vec3SIMD& point, float& pdf) const = 0;
+    virtual float pdf(int light_index, const Vec3SIMD& point) const = 0;
+
+    // Emitted power in the units the renderer shades with (luminance).
+    static float power(const Light& light, float scene_radius);
+};
+
+#endif // LIGHT_SAMPLER_H
@@ -0,0 +1,60 @@
+#ifndef LIGHT_TABLE_H
+#define LIGHT_TABLE_H
+
+#include <vector>
+#include <memory>
+#include "Light.h"
+#include "Vec3SIMD.h"
+#include "Ray.h"
+
+class EnvironmentLight;
+
+// Scene lights flattened into parallel arrays, built once per scene. The
+// integrator switches on type[i] instead of casting Light objects, and all
+// per-light constants (cone cosine, quad area and its inverse) are computed
+// here rather than per shading point. Index i matches the Light vector the
+// table was built from, so LightSampler indices apply directly.
+class LightTable {
+public:
+    void build(const std::vector<std::shared_ptr<Light>>& lights);
+    size_t size() const { return type.size(); }
+    bool empty() const { return type.empty(); }
+
+    // Picks a point on light i using u1, u2 in [0,1). to_light is normalized,
+    // distance is infinite for directional lights.
+    bool sample_direction(int i, const Vec3SIMD& point, float u1, float u2, Vec3SIMD& to_light, float& distance) const;
+    // Intensity arriving at point along to_light, before the receiver cosine.
+    // For area and triangle lights this is radiance / solid_angle_pdf.
+    Vec3SIMD incident(int i, const Vec3SIMD& point, const Vec3SIMD& to_light, float distance) const;
+
+    // Point, spot and directional lights can only be reached by light sampling.
+    bool is_delta(int i) const { return type[i] == LightType::Point || type[i] == LightType::Spot || type[i] == LightType::Directional; }
+    // Solid angle density of sample_direction() from point for area,
+    // triangle or environment light i, given the direction and distance to
+    // the light. Triangles that subtend a large solid angle are sampled
+    // uniformly in it.
+    float solid_angle_pdf(int i, const Vec3SIMD& point, const Vec3SIMD& to_light, float distance) const;
+    // Radiance leaving area or triangle light i; both faces emit.
+    Vec3SIMD radiance(int i) const { return intensity[i] * inv_area[i]; }
+    // Closest area light hit by ray before t_max, so BSDF-sampled paths can
+    // find emitters that are not part of the BVH.
+    bool intersect(const Ray& ray, float t_max, int& index, float& t) const;
+
+    std::vector<LightType> type;
+    std::vector<Vec3SIMD> position;    // point / spot / quad corner / triangle v0
+    std::vector<Vec3SIMD> direction;   // directional + spot: travel direction, area + triangle: normal
+    std::vector<Vec3SIMD> intensity;
+    std::vector<Vec3SIMD> edge_u;      // area: u * width, triangle: v1 - v0
+    std::vector<Vec3SIMD> edge_v;      // area: v * height, triangle: v2 - v0
+    std::vector<float> cos_cone;       // spot: cos of the cone half angle
+    std::vector<float> radius;         // directional: sun disk radius, point/spot: bulb radius
+    std::vector<float> area;
+    std::vector<float> inv_area;
+    std::vector<int> area_indices;     // quads intersect() tests; triangles are in the BVH
+    // At most one; points into the Light vector the table was built from,
+    // which must outlive the table. Misses look it up by environment_index.
+    const EnvironmentLight* environment = nullptr;
+    int environment_index = -1;
+};
+
+#endif // LIGHT_TABLE_H
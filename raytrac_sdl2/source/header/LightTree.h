@@ -0,0 +1,60 @@
+#ifndef LIGHT_TREE_H
+#define LIGHT_TREE_H
+
+#include <cstdint>
+#include "LightSampler.h"
+#include "AABB.h"
+
+// Spatial and directional extent of one light or a group of lights.
+struct LightBounds {
+    AABB bounds;
+    float phi = 0.0f;              // total power
+    Vec3SIMD w = Vec3SIMD(0, 0, 1); // emission cone axis
+    float cos_theta_o = 1.0f;      // spread of the normals around w
+    float cos_theta_e = 0.0f;      // how far past the normals light still leaves
+    bool two_sided = false;
+
+    // Conservative estimate of the light reaching point; 0 means it cannot.
+    float importance(const Vec3SIMD& point) const;
+    static LightBounds merge(const LightBounds& a, const LightBounds& b);
+};
+
+// Light BVH: each node aggregates power, bounds and orientation cone of its
+// subtree. Sampling descends from the root choosing a child in proportion
+// to its importance for the shading point, so one light is picked in
+// O(log n) with a probability that follows its likely contribution.
+// Directional and environment lights have no position and are sampled
+// uniformly beside the tree; together with the tree they split the
+// selection probability by count (infinite_probability), so the scene
+// radius that power() would scale them by is not used.
+class LightTree : public LightSampler {
+public:
+    void build(const std::vector<std::shared_ptr<Light>>& lights, float /*scene_radius*/) override;
+    int sample(float u, const Vec3SIMD& point, float& pdf) const override;
+    float pdf(int light_index, const Vec3SIMD& point) const override;
+
+    static bool light_bounds(const Light& light, LightBounds& out);
+
+private:
+    struct Node {
+        LightBounds bounds;
+        int index = -1;            // light index for leaves, second child otherwise
+        bool is_leaf = false;
+    };
+    struct BuildItem {
+        int light;
+        LightBounds bounds;
+        Vec3SIMD centroid;
+    };
+
+    int build_node(std::vector<BuildItem>& items, size_t begin, size_t end, uint64_t trail, int depth);
+    float infinite_probability() const;
+
+    std::vector<Node> nodes;       // first child follows its parent
+    std::vector<int> infinite_lights;
+    std::vector<int> infinite_slot; // light index -> position in infinite_lights, -1 if bounded
+    std::vector<uint64_t> light_trail; // root-to-leaf branch bits per bounded light
+    std::vector<int> light_depth;
+};
+
+#endif // LIGHT_TREE_H
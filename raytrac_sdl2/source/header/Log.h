@@ -0,0 +1,127 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// Leveled logging with compile-time filtering.
+//
+//   LOG_INFO("Loaded " << count << " triangles");
+//   LOG_WARN_LIMITED(8, "Face " << i << " has " << n << " vertices, skipped");
+//   LOG_TRACE("getOpacity: alpha " << alpha);
+//
+// RAYTRAC_LOG_LEVEL is the lowest level compiled in; statements below it
+// expand to nothing, arguments included, so trace points may sit on shading
+// paths. Release builds default to info, debug builds to debug; define
+// RAYTRAC_LOG_LEVEL=RAYTRAC_LOG_TRACE in the project to see trace output.
+//
+// The _LIMITED forms print the first n messages of each call site, note that
+// the rest are suppressed, and after that only count. Trace is always
+// limited. Lines are written whole, so threads never interleave.
+#define RAYTRAC_LOG_TRACE 0
+#define RAYTRAC_LOG_DEBUG 1
+#define RAYTRAC_LOG_INFO 2
+#define RAYTRAC_LOG_WARN 3
+#define RAYTRAC_LOG_ERROR 4
+#define RAYTRAC_LOG_OFF 5
+
+#ifndef RAYTRAC_LOG_LEVEL
+#ifdef NDEBUG
+#define RAYTRAC_LOG_LEVEL RAYTRAC_LOG_INFO
+#else
+#define RAYTRAC_LOG_LEVEL RAYTRAC_LOG_DEBUG
+#endif
+#endif
+
+namespace Log {
+    enum class Level { Trace, Debug, Info, Warn, Error };
+
+    // Messages a trace point prints before it goes quiet
+    constexpr uint32_t trace_limit = 32;
+
+    // One line, "[warn] Texture.cpp:139 message", on std::cout for trace to
+    // info and std::cerr for warn and error. `last` marks the final message
+    // a rate-limited site prints.
+    void write(Level level, const char* file, int line, const std::string& message, bool last = false);
+
+    // Occurrences of one call site
+    class Site {
+    public:
+        uint32_t hit() {
+            // Saturates so a long render cannot wrap around and print again
+            uint32_t n = count.load(std::memory_order_relaxed);
+            while (n != UINT32_MAX && !count.compare_exchange_weak(n, n + 1, std::memory_order_relaxed)) {}
+            return n == UINT32_MAX ? n : n + 1;
+        }
+
+    private:
+        std::atomic<uint32_t> count{ 0 };
+    };
+
+    // Total messages dropped by rate limiting, for the end of a render
+    uint64_t suppressed();
+    void note_suppressed();
+}
+
+#define RAYTRAC_LOG_EMIT(level, expr) \
+    do { \
+        std::ostringstream raytrac_log_stream_; \
+        raytrac_log_stream_ << expr; \
+        Log::write(level, __FILE__, __LINE__, raytrac_log_stream_.str()); \
+    } while (0)
+
+#define RAYTRAC_LOG_EMIT_LIMITED(level, limit, expr) \
+    do { \
+        static Log::Site raytrac_log_site_; \
+        const uint32_t raytrac_log_n_ = raytrac_log_site_.hit(); \
+        if (raytrac_log_n_ <= static_cast<uint32_t>(limit)) { \
+            std::ostringstream raytrac_log_stream_; \
+            raytrac_log_stream_ << expr; \
+            Log::write(level, __FILE__, __LINE__, raytrac_log_stream_.str(), raytrac_log_n_ == static_cast<uint32_t>(limit)); \
+        } \
+        else { \
+            Log::note_suppressed(); \
+        } \
+    } while (0)
+
+#define RAYTRAC_LOG_DISCARD() do {} while (0)
+
+#if RAYTRAC_LOG_LEVEL <= RAYTRAC_LOG_TRACE
+#define LOG_TRACE(expr) RAYTRAC_LOG_EMIT_LIMITED(Log::Level::Trace, Log::trace_limit, expr)
+#else
+#define LOG_TRACE(expr) RAYTRAC_LOG_DISCARD()
+#endif
+
+#if RAYTRAC_LOG_LEVEL <= RAYTRAC_LOG_DEBUG
+#define LOG_DEBUG(expr) RAYTRAC_LOG_EMIT(Log::Level::Debug, expr)
+#define LOG_DEBUG_LIMITED(limit, expr) RAYTRAC_LOG_EMIT_LIMITED(Log::Level::Debug, limit, expr)
+#else
+#define LOG_DEBUG(expr) RAYTRAC_LOG_DISCARD()
+#define LOG_DEBUG_LIMITED(limit, expr) RAYTRAC_LOG_DISCARD()
+#endif
+
+#if RAYTRAC_LOG_LEVEL <= RAYTRAC_LOG_INFO
+#define LOG_INFO(expr) RAYTRAC_LOG_EMIT(Log::Level::Info, expr)
+#else
+#define LOG_INFO(expr) RAYTRAC_LOG_DISCARD()
+#endif
+
+#if RAYTRAC_LOG_LEVEL <= RAYTRAC_LOG_WARN
+#define LOG_WARN(expr) RAYTRAC_LOG_EMIT(Log::Level::Warn, expr)
+#define LOG_WARN_LIMITED(limit, expr) RAYTRAC_LOG_EMIT_LIMITED(Log::Level::Warn, limit, expr)
+#else
+#define LOG_WARN(expr) RAYTRAC_LOG_DISCARD()
+#define LOG_WARN_LIMITED(limit, expr) RAYTRAC_LOG_DISCARD()
+#endif
+
+#if RAYTRAC_LOG_LEVEL <= RAYTRAC_LOG_ERROR
+#define LOG_ERROR(expr) RAYTRAC_LOG_EMIT(Log::Level::Error, expr)
+#define LOG_ERROR_LIMITED(limit, expr) RAYTRAC_LOG_EMIT_LIMITED(Log::Level::Error, limit, expr)
+#else
+#define LOG_ERROR(expr) RAYTRAC_LOG_DISCARD()
+#define LOG_ERROR_LIMITED(limit, expr) RAYTRAC_LOG_DISCARD()
+#endif
+
+#endif // LOG_H
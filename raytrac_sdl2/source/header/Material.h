@@ -5,26 +5,11 @@
 #include "Hittable.h"
 #include <memory>
 #include "Texture.h"
+#include "MaterialType.h"
+#include "UVTransform.h"
 
-enum class MaterialType {
-    PrincipledBSDF,
-    Metal,
-    Dielectric,
-    Volumetric,   
-   
-};
-struct UVData {
-    Vec2 original;
-    Vec2 transformed;
-};
+class AlphaMask;
 
-enum class WrapMode {
-    Repeat,
-    Mirror,
-    Clamp,
-    Planar,
-    Cubic
-};
 struct MaterialProperty {
     Vec3 color;
     float intensity;
@@ -43,6 +28,29 @@ struct MaterialProperty {
         : color(1.0f, 1.0f, 1.0f), intensity(i), texture(tex), alpha(a) {}
     MaterialProperty(const Vec3& c = Vec3(1, 1, 1), float i = 1.0f, std::shared_ptr<Texture> tex = nullptr)
         : color(c), intensity(i), texture(tex) {}
+
+    // bake() sonras geerli: kanal sabitse color * intensity (doku tek renkse onun rengiyle)
+    Vec3 value;
+    bool is_constant = false;
+
+    // Tek renkli dokuyu sabite indirger; bir doku okumas kaldrldysa true dner
+    bool bake() {
+        if (texture && texture->is_constant()) {
+            value = texture->constant_color() * intensity;
+            is_constant = true;
+            return true;
+        }
+        value = color * intensity;
+        is_constant = !texture;
+        return false;
+    }
+    Vec3 evaluate(const Vec2& uv) const {
+        if (is_constant)
+            return value;
+        if (texture)
+            return texture->get_color(uv.u, uv.v) * intensity;
+        return color * intensity;
+    }
 };
 
 class Material {
@@ -72,11 +80,29 @@ public:
 
 
     virtual ~Material() = default;
+    // Sahne yklendikten sonra, render'dan nce bir kez arlr (MaterialTable::compile);
+    // ayarlardan tretilen nbellekler burada yeniden kurulur. Dn: sabite indirgenen,
+    // yani isabet bana artk yaplmayan doku okumas says
+    virtual int finalize() { return 0; }
+    // finalize() sonras: gei srasnda test edilen 1 bitlik opaklk maskesi, yoksa nullptr
+    virtual const AlphaMask* alpha_mask() const { return nullptr; }
     MaterialProperty shininess;
     MaterialProperty metallic;
     virtual MaterialType type() const = 0;
     
     virtual bool scatter(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered) const = 0;
+    // Ik rneklemesi ve MIS iin. wo izleyiciye, wi a doru (birim vektrler).
+    // eval: BSDF * cos(n, wi). pdf: scatter()'n wi'yi setii kat a younluu.
+    // Varsaylan: Lambert (kosins arlkl rnekleme).
+    virtual Vec3SIMD eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi) const;
+    virtual float pdf(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi) const;
+    // eval() ve pdf() tek arda; analitik BSDF'ler ortak ara deerleri paylar
+    virtual Vec3SIMD eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi, float& pdf) const;
+    // scatter() ve seilen ynn pdf'i tek arda (spekler malzemelerde pdf 0).
+    // Varsaylan scatter() + pdf(); yol izleyici her sekmede bunu kullanr.
+    virtual bool sample(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered, float& pdf) const;
+    // Delta dalmlar (ayna, cam, hacim) k rneklemesine katlmaz
+    virtual bool is_specular() const { return false; }
     virtual float get_metallic() const { return metallic.getValue(); }
     virtual Vec3SIMD emitted(double u, double v, const Vec3SIMD& p) const {
         return Vec3SIMD(0, 0, 0);
@@ -99,6 +125,8 @@ public:
     virtual bool has_normal_map() const { return false; }
     virtual Vec3 get_normal_from_map(double u, double v) const { return Vec3(0, 0, 1); }
     virtual float get_normal_strength() const { return 1.0f; }
+    // Yzey rengi (denoiser albedo AOV'si iin)
+    virtual Vec3 get_albedo(double u, double v) const { return albedoProperty.color * albedoProperty.intensity; }
     virtual float get_shininess() const {
         return shininess.getValue() * 128.0f;  // veya shininess.intensity
     }
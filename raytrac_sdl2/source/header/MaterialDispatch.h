@@ -0,0 +1,64 @@
+#ifndef MATERIAL_DISPATCH_H
+#define MATERIAL_DISPATCH_H
+
+#include "MaterialTable.h"
+#include "PrincipledBSDF.h"
+#include "Metal.h"
+#include "Dielectric.h"
+#include "Volumetric.h"
+#include "EmissiveMaterial.h"
+
+// Material calls made on every path vertex, dispatched with a switch over
+// the closed set of material types. The qualified calls bind directly to
+// the concrete class, so the per-hit vtable loads and indirect branches go
+// away; rarely used queries stay on the virtual interface.
+namespace MaterialDispatch {
+
+    inline Vec3SIMD emitted(const CompiledMaterial& material, const HitRecord& rec) {
+        if (!material.emissive)
+            return Vec3SIMD(0.0f, 0.0f, 0.0f);
+        if (material.uniform_emission)
+            return material.emission;
+        return material.material->emitted(rec.u, rec.v, rec.point);
+    }
+
+    // Material::sample: direction, weight and the pdf of the direction (0 for delta lobes)
+    inline bool sample(const CompiledMaterial& material, const Ray& r_in, const HitRecord& rec,
+        Vec3SIMD& attenuation, Ray& scattered, float& pdf) {
+        switch (material.type) {
+        case MaterialType::PrincipledBSDF:
+            return static_cast<const PrincipledBSDF*>(material.material)->PrincipledBSDF::sample(r_in, rec, attenuation, scattered, pdf);
+        case MaterialType::Metal:
+            return static_cast<const Metal*>(material.material)->Metal::sample(r_in, rec, attenuation, scattered, pdf);
+        case MaterialType::Dielectric:
+            pdf = 0.0f;
+            return static_cast<const Dielectric*>(material.material)->Dielectric::scatter(r_in, rec, attenuation, scattered);
+        case MaterialType::Volumetric:
+            pdf = 0.0f;
+            return static_cast<const Volumetric*>(material.material)->Volumetric::scatter(r_in, rec, attenuation, scattered);
+        case MaterialType::Emissive:
+            pdf = 0.0f;
+            return false;
+        }
+        return false;
+    }
+
+    // Material::eval with the pdf of wi, for light sampling
+    inline Vec3SIMD eval(const CompiledMaterial& material, const HitRecord& rec,
+        const Vec3SIMD& wo, const Vec3SIMD& wi, float& pdf) {
+        switch (material.type) {
+        case MaterialType::PrincipledBSDF:
+            return static_cast<const PrincipledBSDF*>(material.material)->PrincipledBSDF::eval(rec, wo, wi, pdf);
+        case MaterialType::Metal:
+            return static_cast<const Metal*>(material.material)->Metal::eval(rec, wo, wi, pdf);
+        case MaterialType::Dielectric:
+        case MaterialType::Volumetric:
+        case MaterialType::Emissive:
+            break;
+        }
+        pdf = 0.0f;
+        return Vec3SIMD(0.0f, 0.0f, 0.0f);
+    }
+}
+
+#endif // MATERIAL_DISPATCH_H
@@ -0,0 +1,68 @@
+#ifndef MATERIAL_TABLE_H
+#define MATERIAL_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "MaterialType.h"
+#include "Vec3SIMD.h"
+
+class Material;
+class AlphaMask;
+
+// Per-hit facts about a material, gathered once by MaterialTable::compile()
+// so the integrator reads plain fields instead of making virtual calls.
+struct CompiledMaterial {
+    MaterialType type = MaterialType::PrincipledBSDF;
+    bool specular = false;           // Delta lobes only: no light sampling, no MIS
+    bool emissive = false;           // emitted() can be non-zero
+    bool uniform_emission = true;    // emitted() == emission everywhere
+    bool normal_map = false;
+    bool diffuse = false;            // Rough, non-metal, no clearcoat: radiance nearly view independent (RadianceCache)
+    float normal_strength = 1.0f;
+    float scattering_factor = 0.0f;
+    const AlphaMask* alpha_mask = nullptr;   // Cut-out texels; triangles skip hits there during traversal
+    Vec3SIMD emission = Vec3SIMD(0.0f, 0.0f, 0.0f);
+    const Material* material = nullptr;
+};
+
+// Owns the scene's materials; primitives and hit records refer to them by a
+// 32-bit id. Copying the id on every candidate hit replaces the shared_ptr
+// copy whose atomic refcount all render threads fought over.
+//
+// Materials are registered while the scene loads, once per object, and stay
+// alive for the rest of the process. add() may be called from several
+// loader threads; get() is lock free and must not race a reallocating add(),
+// which holds as long as nothing registers materials while rendering.
+// compile() must run after the last material is registered or changed and
+// before rendering; the Renderer does this at the end of create_scene.
+class MaterialTable {
+public:
+    static constexpr uint32_t none = 0xffffffffu;
+
+    // Id of the material, registering it on first use; none for nullptr
+    uint32_t add(const std::shared_ptr<Material>& material);
+
+    Material* get(uint32_t id) const { return id < pointers.size() ? pointers[id] : nullptr; }
+    const std::shared_ptr<Material>& shared(uint32_t id) const;
+    size_t size() const { return pointers.size(); }
+
+    // Finalizes every registered material (folding single-colour textures into
+    // constants) and rebuilds the compiled records
+    void compile();
+    const CompiledMaterial& compiled(uint32_t id) const { return id < records.size() ? records[id] : fallback; }
+
+private:
+    std::vector<Material*> pointers;
+    std::vector<std::shared_ptr<Material>> owners;
+    std::unordered_map<const Material*, uint32_t> ids;
+    std::vector<CompiledMaterial> records;
+    CompiledMaterial fallback;
+    std::mutex mutex;
+};
+
+extern MaterialTable scene_materials;
+
+#endif // MATERIAL_TABLE_H
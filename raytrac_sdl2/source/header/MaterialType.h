@@ -0,0 +1,16 @@
+#ifndef MATERIAL_TYPE_H
+#define MATERIAL_TYPE_H
+
+#include <cstdint>
+
+// Closed set of material kinds. The integrator switches on it instead of
+// calling through the Material vtable (see MaterialDispatch.h).
+enum class MaterialType : uint8_t {
+    PrincipledBSDF,
+    Metal,
+    Dielectric,
+    Volumetric,
+    Emissive,     // Light source surface: emits, never scatters
+};
+
+#endif // MATERIAL_TYPE_H
@@ -23,7 +23,7 @@ public:
     Vec2 t0, t1, t2;  // Texture coordinates
     std::vector<Vec2> globalUVs;
     Mesh(const std::vector<Vec3>& vertices, const std::vector<Vec3>& normals, const std::vector<Vec2>& texCoords, const std::vector<Face>& faces, const std::shared_ptr<Material>& assignedMaterial)
-        : vertices(vertices), normals(normals), texCoords(texCoords), faces(faces), material(assignedMaterial) {
+        : vertices(vertices), normals(normals), texCoords(texCoords), faces(faces), material(assignedMaterial), material_id(scene_materials.add(assignedMaterial)) {
         // dier ye deikenler iin balatma/gncelleme
     }    void triangulate();
     int smoothGroup;
@@ -70,7 +70,8 @@ private:
     std::vector<Vec3> normals;
     std::vector<Vec2> texCoords;
     std::vector<Face> faces;
-    std::shared_ptr<Material> material;
+    std::shared_ptr<Material> material;   // retilen genlere verilir
+    uint32_t material_id = MaterialTable::none;
     Vec3 min_point;
     Vec3 max_point;
    
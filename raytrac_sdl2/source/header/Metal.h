@@ -5,6 +5,7 @@
 #include "Texture.h"
 #include "Vec2.h"
 #include "Vec3.h"
+#include "Microfacet.h"
 #include <memory>
 
 
@@ -18,6 +19,8 @@ public:
         Vec2 translation{ 0.0, 0.0 };
         Vec2 tilingFactor{ 1.0, 1.0 };
         WrapMode wrapMode{ WrapMode::Repeat };
+
+        UVTransform bake() const { return UVTransform::bake(scale, rotation_degrees, translation, tilingFactor, wrapMode); }
     };
 
     Metal(const Vec3& albedo, float roughness, float metallic, float fuzz, float clearcoat);
@@ -29,12 +32,17 @@ public:
     virtual Vec3SIMD emitted(double u, double v, const Vec3SIMD& p) const override;
    
     virtual bool scatter(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered) const override;
+    virtual Vec3SIMD eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi) const override;
+    virtual float pdf(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi) const override;
+    virtual Vec3SIMD eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi, float& pdf) const override;
+    virtual bool sample(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered, float& pdf) const override;
     virtual double getIndexOfRefraction() const override;
   
 
    
 
     void setTextureTransform(const TextureTransform& transform);
+    int finalize() override;
     void setTilingFactor(const Vec2& factor) { tilingFactor = factor; }
     void set_normal_map(std::shared_ptr<Texture> normalMap, float normalStrength = 1.0f);
 
@@ -52,6 +60,7 @@ public:
     void setEmission(const Vec3& emission, float intensity = 0.0f);
     void setEmissionTexture(const std::shared_ptr<Texture>& tex, float intensity = 1.0f);
     Vec2 applyTextureTransform(double u, double v) const;
+    Vec3 get_albedo(double u, double v) const override { return getPropertyValue(albedoProperty, Vec2(u, v)); }
     float get_scattering_factor() const override {
         // Example formula incorporating reflectivity and roughness
         return  0.01f;
@@ -77,14 +86,13 @@ public:
     MaterialProperty emissionProperty;
     Vec2 tilingFactor;
     TextureTransform textureTransform;
+    UVTransform uvTransform = textureTransform.bake();
 private:
    
 
   
     // Helper methods
     float max(float a, float b) const { return a > b ? a : b; }
-    Vec2 applyWrapMode(double u, double v) const;
-    float computeAmbientOcclusion(const Vec3& point, const Vec3& normal) const;
     Vec3 computeClearcoat(const Vec3& reflected, const Vec3& normal) const;
     Vec3 computeScatterDirection(const Vec3& N, const Vec3& T, const Vec3& B, float roughness) const;
     void createCoordinateSystem(const Vec3& N, Vec3& T, Vec3& B) const;
@@ -92,7 +100,6 @@ private:
    
     Vec3 computeFresnel(const Vec3& F0, float cosTheta) const;
     Vec3 getPropertyValue(const MaterialProperty& prop, const Vec2& uv) const;
-    Vec2 applyTiling(double u, double v) const;
    
     // GGX BRDF iin yeni yardmc fonksiyonlar
     float DistributionGGX(const Vec3& N, const Vec3& H, float roughness) const;
@@ -101,6 +108,7 @@ private:
     Vec3 fresnelSchlick(float cosTheta, const Vec3& F0) const;
     // New helper methods for PBR
     Vec3 computeAnisotropicDirection(const Vec3& N, const Vec3& T, const Vec3& B, float roughness, float anisotropy) const;
+    MicrofacetLobes lobes_at(const HitRecord& rec) const;
 };
 
 #endif // METAL_H
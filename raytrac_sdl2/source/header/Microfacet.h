@@ -0,0 +1,51 @@
+#ifndef MICROFACET_H
+#define MICROFACET_H
+
+#include "Vec3SIMD.h"
+
+// Diffuse + GGX specular (+ optional clearcoat) reflection shared by
+// PrincipledBSDF and Metal. sample() picks a direction from exactly the
+// density pdf() reports, so materials can return eval / pdf as their
+// scatter weight and the integrator can MIS-weight light samples.
+//
+// Conventions: n, wo (towards the viewer) and wi (towards the light) are
+// normalized. eval() includes the cosine term: f(wo, wi) * cos(n, wi).
+struct MicrofacetLobes {
+    Vec3SIMD albedo = Vec3SIMD(0.8f, 0.8f, 0.8f);
+    Vec3SIMD f0 = Vec3SIMD(0.04f, 0.04f, 0.04f);
+    float roughness = 0.5f;
+    float metallic = 0.0f;
+    float clearcoat = 0.0f;
+    float clearcoat_roughness = 0.1f;
+
+    Vec3SIMD eval(const Vec3SIMD& n, const Vec3SIMD& wo, const Vec3SIMD& wi) const;
+    float pdf(const Vec3SIMD& n, const Vec3SIMD& wo, const Vec3SIMD& wi) const;
+    // Both at once; the half vector and GGX term are shared.
+    Vec3SIMD eval(const Vec3SIMD& n, const Vec3SIMD& wo, const Vec3SIMD& wi, float& pdf) const;
+    // u0 picks the lobe, u1/u2 the direction. Returns false below the surface.
+    bool sample(const Vec3SIMD& n, const Vec3SIMD& wo, float u0, float u1, float u2, Vec3SIMD& wi) const;
+    // Direction plus weight = eval / pdf and pdf, with one evaluation.
+    bool sample(const Vec3SIMD& n, const Vec3SIMD& wo, float u0, float u1, float u2,
+        Vec3SIMD& wi, Vec3SIMD& weight, float& pdf) const;
+
+    // Roughness below this is clamped; GGX stays finite and MIS still applies.
+    static constexpr float min_roughness = 0.03f;
+
+    static float ggx_distribution(float n_dot_h, float roughness);
+    static float smith_geometry(float n_dot_v, float n_dot_l, float roughness);
+    static Vec3SIMD fresnel_schlick(float cos_theta, const Vec3SIMD& f0);
+    static Vec3SIMD sample_ggx_half(float u1, float u2, float roughness, const Vec3SIMD& n);
+    static Vec3SIMD sample_cosine(float u1, float u2, const Vec3SIMD& n);
+
+private:
+    void lobe_probabilities(float& p_diffuse, float& p_specular, float& p_clearcoat) const;
+};
+
+// Power heuristic (beta = 2) for one sample from each of two strategies.
+inline float power_heuristic(float pdf_a, float pdf_b) {
+    float a2 = pdf_a * pdf_a;
+    float b2 = pdf_b * pdf_b;
+    return a2 + b2 > 0.0f ? a2 / (a2 + b2) : 0.0f;
+}
+
+#endif // MICROFACET_H
@@ -12,7 +12,7 @@ struct OptixHitResult {
     int hitObjectID;
     float3 hitPoint;
     float3 normal;
-    std::shared_ptr<Material> material;
+    uint32_t material_id = MaterialTable::none;
 };
 
 // CUDA runtime API  
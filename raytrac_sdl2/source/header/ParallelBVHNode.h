@@ -4,6 +4,7 @@
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <bit>
 #include "Hittable.h"
 #include "AABB.h"
 #include "OptixWrapper.h"
@@ -29,6 +30,11 @@ public:
    
 
      bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const ;
+     // lk engelde durur; en yakn kesiimi aramaz
+     bool occluded(const Ray& r, double t_min, double t_max) const override;
+     // Paket bir dmn kutusunu bir kez ykler; kutuyu skalayan ve
+     // engeli bulunan nlar alt dmlere inmez
+     uint32_t occluded_packet(const Ray* rays, const float* t_max, uint32_t active, double t_min) const override;
 
 private:
     static bool box_compare(const std::shared_ptr<Hittable> a, const std::shared_ptr<Hittable> b, int axis);
@@ -9,6 +9,8 @@
 #include "Hittable.h"
 #include <memory>
 #include "SmartUVProjection.h"
+#include "Microfacet.h"
+#include "AlphaMask.h"
 
 
 
@@ -29,6 +31,8 @@ public:
             WrapMode wrap = WrapMode::Repeat
         ) : scale(scale), rotation_degrees(rotation), translation(translation),
             tilingFactor(tiling), wrapMode(wrap) {}
+
+        UVTransform bake() const { return UVTransform::bake(scale, rotation_degrees, translation, tilingFactor, wrapMode); }
     };
 
   
@@ -57,10 +61,16 @@ public:
     bool has_normal_map() const override { return normalProperty.texture != nullptr; }
     Vec3 get_normal_from_map(double u, double v) const override;
     float get_normal_strength() const override { return normalProperty.intensity; }
+    Vec3 get_albedo(double u, double v) const override;
 
    
 
     void setTextureTransform(const TextureTransform& transform);
+    int finalize() override;
+    const AlphaMask* alpha_mask() const override { return alphaMask.get(); }
+    // finalize() sonras: przl, metal olmayan ve vernisiz; GGX/clearcoat parlamas
+    // yok denecek kadar az, kan nm bak ynne neredeyse bal deil
+    bool is_diffuse_dominated() const;
     void setTilingFactor(const Vec2& factor) { tilingFactor = factor; }
     void set_normal_map(std::shared_ptr<Texture> normalMap, float normalStrength = 1.0f);
 
@@ -83,8 +93,12 @@ public:
     float get_roughness(float u, float v) const {
         return getPropertyValue(roughnessProperty, Vec2(u, v)).x;
     }
-    float getOpacity(const Vec2& uv) const;
     virtual bool scatter(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered) const override;
+    virtual Vec3SIMD emitted(double u, double v, const Vec3SIMD& p) const override;
+    virtual Vec3SIMD eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi) const override;
+    virtual float pdf(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi) const override;
+    virtual Vec3SIMD eval(const HitRecord& rec, const Vec3SIMD& wo, const Vec3SIMD& wi, float& pdf) const override;
+    virtual bool sample(const Ray& r_in, const HitRecord& rec, Vec3SIMD& attenuation, Ray& scattered, float& pdf) const override;
     float get_scattering_factor() const override {
         // Example formula incorporating reflectivity and roughness
         return 0.01f;
@@ -96,6 +110,7 @@ public:
     MaterialProperty normalProperty;
     Vec2 tilingFactor;
     TextureTransform textureTransform; 
+    UVTransform uvTransform = textureTransform.bake(); // textureTransform'un nceden hesaplanm hali
     MaterialProperty specularProperty;
     MaterialProperty emissionProperty;
    
@@ -105,6 +120,8 @@ private:
     float subsurfaceRadius = 0.0f;
     float clearcoat=0.0f;
     float clearcoatRoughness=0.0f;
+    bool constant_lobes = false; // albedo/roughness/metallic sabit: lobes_at UV hesaplamaz
+    std::shared_ptr<AlphaMask> alphaMask; // finalize()'da opaklk dokusundan kurulur
     float anisotropic=0;
     Vec3SIMD anisotropicDirection;
     Vec3SIMD subsurfaceColor = Vec3SIMD(0, 0, 0);
@@ -112,19 +129,10 @@ private:
      
     // Helper methods
     float max(float a, float b) const { return a > b ? a : b; }
-    UVData transformUV(double u, double v) const;
-    Vec2 applyWrapMode(const UVData& uvData) const;    
-    Vec2 applyPlanarWrapping(double u, double v) const;
-  
-    Vec2 applyRepeatWrapping(const Vec2& uv) const;
-    Vec2 applyMirrorWrapping(const Vec2& uv) const;
-    Vec2 applyClampWrapping(const Vec2& uv) const;
-    Vec2 applyPlanarWrapping(const Vec2& uv) const;
-    Vec2 applyCubicWrapping(const Vec2& uv) const;
-
-    Vec3SIMD fresnelSchlick(float cosTheta, const Vec3SIMD& F0) const;
-
-    Vec3SIMD fresnelSchlickRoughness(float cosTheta, const Vec3SIMD& F0, float roughness) const;
+    // Doku okumalarnn UV'si: Smart UV projeksiyonu varsa mesh UV'leri, yoksa dnm
+    Vec2 texture_uv(double u, double v) const {
+        return useSmartUVProjection ? Vec2(u, v) : uvTransform.apply(u, v);
+    }
 
     double calculate_sss_density(double distance) const;
 
@@ -133,28 +141,16 @@ private:
     Vec3SIMD calculate_sss_attenuation(double distance) const;
 
     Vec3SIMD sample_henyey_greenstein(const Vec3SIMD& wi, double g) const;
+    // Dokulardan okunan deerlerle bu noktadaki diffuse/GGX/clearcoat loblar
+    MicrofacetLobes lobes_at(const HitRecord& rec) const;
     // Existing methods
     virtual MaterialType type() const override { return MaterialType::PrincipledBSDF; }
     
-    Vec3SIMD computeScatterDirection(const Vec3SIMD& N, const Vec3SIMD& T, const Vec3SIMD& B, float roughness) const;
-    void createCoordinateSystem(const Vec3SIMD& N, Vec3SIMD& T, Vec3SIMD& B) const;
-    Vec3SIMD reflect(const Vec3SIMD& v, const Vec3SIMD& n) const;
-   
-  
-    Vec3SIMD computeFresnel(const Vec3SIMD& F0, float cosTheta) const;
-    float DistributionGGX(const Vec3SIMD& N, const Vec3SIMD& H, float roughness) const;
-    float GeometrySchlickGGX(float NdotV, float roughness) const;
-    float GeometrySmith(const Vec3SIMD& N, const Vec3SIMD& V, const Vec3SIMD& L, float roughness) const;
-  
     Vec3 getPropertyValue(const MaterialProperty& prop, const Vec2& uv) const;
-    Vec2 applyTiling(double u, double v) const;
-    Vec3SIMD importanceSampleGGX(float u1, float u2, float roughness, const Vec3SIMD& N) const;
    
   
     // New helper methods for PBR
     Vec3SIMD computeSubsurfaceScattering(const Vec3SIMD& N, const Vec3SIMD& V, float thickness) const;
-    Vec3SIMD computeAnisotropicDirection(const Vec3SIMD& N, const Vec3SIMD& T, const Vec3SIMD& B, float roughness, float anisotropy) const;
   
-    float computeAmbientOcclusion(const Vec3SIMD& point, const Vec3SIMD& normal) const;
     Vec3SIMD albedoValue;
 };
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef RADIANCE_CACHE_H
+#define RADIANCE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "AABB.h"
+#include "Vec3SIMD.h"
+
+// World-space cache of outgoing radiance at diffuse path vertices, for
+// low sample count previews (--radiance-cache).
+//
+// Cells of a uniform grid over the scene are split by the dominant axis of
+// the surface normal and hashed into a fixed open-addressing table. Paths
+// add the radiance they actually gathered at every diffuse vertex; from the
+// second bounce on, a path that lands in a cell with enough samples takes
+// the cell average and stops. The result is biased, so final frames leave
+// the cache off. All methods are safe to call from the render threads.
+class RadianceCache {
+public:
+    static constexpr uint32_t npos = 0xffffffffu;
+    // A cell answers lookups once it holds this many samples
+    static constexpr uint32_t min_samples = 16;
+    // Longest path that records vertices; longer paths record the first ones
+    static constexpr int max_path_vertices = 16;
+
+    // Sizes the grid so the scene's longest side spans `resolution` cells.
+    void build(const AABB& scene_box, int resolution = 256, size_t capacity = size_t(1) << 19);
+    void clear();
+    bool valid() const { return capacity_mask != 0; }
+
+    // Slot of the cell holding (point, normal), claimed on first use.
+    // npos when the probe sequence is full.
+    uint32_t slot(const Vec3SIMD& point, const Vec3SIMD& normal);
+    void add(uint32_t slot, const Vec3SIMD& radiance);
+    // Average radiance of the cell, if it holds at least min_samples.
+    bool lookup(const Vec3SIMD& point, const Vec3SIMD& normal, Vec3SIMD& radiance) const;
+
+    size_t used_cells() const { return used.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> key;   // 0 = empty
+        std::atomic<float> r, g, b;
+        std::atomic<uint32_t> count;
+    };
+    static constexpr int max_probes = 16;
+
+    uint64_t key_of(const Vec3SIMD& point, const Vec3SIMD& normal) const;
+    static uint64_t mix(uint64_t key);
+
+    std::unique_ptr<Entry[]> entries;
+    size_t capacity_mask = 0;
+    std::atomic<size_t> used{ 0 };
+    Vec3SIMD origin;
+    float inv_cell = 0.0f;
+};
+
+#endif // RADIANCE_CACHE_H
@@ -0,0 +1,54 @@
+#ifndef RENDERSETTINGS_H
+#define RENDERSETTINGS_H
+
+#include <string>
+#include "globals.h"
+
+// Command line / batch render options. Defaults reproduce the interactive build.
+struct RenderSettings {
+    std::string scene_path;                 // empty -> built-in default scene
+    std::string output_path = "output.png";
+    int width = image_width;
+    int height = image_height;
+    int samples_per_pixel = 1;
+    int samples_per_pass = 1;
+    int max_depth = 0;                      // 0 -> 32; a safety cap, the roulette ends most paths long before
+    int roulette_depth = 3;                 // bounces that always continue before Russian roulette starts
+    float roulette_threshold = 1.0f;        // survival = min(1, max throughput / threshold), 0 -> roulette off
+    unsigned int num_threads = 0;           // 0 -> std::thread::hardware_concurrency()
+    bool denoise = true;
+    bool sun_cache = true;                  // light-space grid for directional shadow rays
+    bool radiance_cache = false;            // biased diffuse indirect cache for previews
+    bool wavefront = false;                 // breadth-first integrator with material-sorted queues
+    int ao_samples = 0;                     // ambient occlusion rays per camera hit, 0 -> no AO pass
+    float ao_radius = 1.0f;                 // occluders farther than this do not count
+    int area_light_samples = 4;             // stratified samples per area-light estimate, rounded to a square <= 25
+    float denoise_budget = 0.25f;           // max share of render time spent on preview denoises
+    // Progressive stopping criteria. Either one switches the renderer from a
+    // fixed sample count to adaptive pass sizes; samples_per_pixel is then
+    // ignored and max_samples_per_pixel is the only cap.
+    float time_budget = 0.0f;               // seconds of rendering incl. final denoise, 0 -> off
+    float noise_target = 0.0f;              // relative RMS error of the pixel mean, 0 -> off
+    int max_samples_per_pixel = 65536;
+    bool headless = false;                  // no window, no video subsystem
+    std::string benchmark;                  // --bench <name>: run a micro benchmark instead of rendering
+};
+
+// Timings collected by Renderer::render_image, printed by the headless mode.
+struct RenderStats {
+    double scene_seconds = 0.0;
+    double render_seconds = 0.0;
+    double total_seconds = 0.0;
+    double denoise_seconds = 0.0;
+    size_t object_count = 0;
+    size_t light_count = 0;
+    int samples_per_pixel = 0;
+    unsigned int num_threads = 0;
+    float noise_estimate = 0.0f;            // relative RMS error at the end of the render
+};
+
+// Returns false on a malformed command line (message already printed).
+bool parse_command_line(int argc, char* argv[], RenderSettings& settings);
+void print_usage(const char* program);
+
+#endif // RENDERSETTINGS_H
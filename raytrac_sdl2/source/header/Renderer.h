@@ -60,15 +60,48 @@
 #include "ThreadLocalRNG.h"
 #include "AtmosphericEffects.h"
 #include "ParallelBVHNode.h"
+#include "RenderSettings.h"
+#include "SceneLoader.h"
+#include "Denoiser.h"
+#include "AliasLightSampler.h"
+#include "LightTree.h"
+#include "LightTable.h"
+#include "TriangleLight.h"
+#include "EnvironmentLight.h"
+#include "SunVisibilityCache.h"
+#include "RadianceCache.h"
 #include <OpenImageDenoise/oidn.hpp>
 
 
-class Renderer {
-public:
+// lk kesiimin denoiser yardmc grntleri (albedo / normal)
+struct PathAOV {
+    Vec3SIMD albedo = Vec3SIMD(0, 0, 0);
+    Vec3SIMD normal = Vec3SIMD(0, 0, 0);
+    float ao = 1.0f;              // settings.ao_samples > 0 iken doldurulur
+};
+
+// Bir pikselin bir geiteki rnek toplamlar; render_chunk ve WavefrontIntegrator doldurur
+struct PixelSums {
+    Vec3SIMD color = Vec3SIMD(0, 0, 0);
+    float luminance_sq = 0.0f;    // rnek bana lminans karesi toplam
+    Vec3SIMD albedo = Vec3SIMD(0, 0, 0);
+    Vec3SIMD normal = Vec3SIMD(0, 0, 0);
+    float ao = 0.0f;
+    void add(const Vec3SIMD& sample_color, const PathAOV& aov);
+};
 
-    static bool isCudaAvailable();
+// Grnrl henz bilinmeyen bir k rnei; contribution MIS arlkl ve pdf'e blnm
+struct ShadowRay {
+    Ray ray;
+    float t_max = 0.0f;
+    Vec3SIMD contribution;
+    bool sun = false;             // SunVisibilityCache'e sorulur
+};
 
-    static void applyOIDNDenoising(SDL_Surface* surface, int numThreads, bool denoise, float blend);
+class Renderer {
+    friend class Benchmark;
+    friend class WavefrontIntegrator;
+public:
 
     Renderer(int image_width, int image_height, int max_depth, int samples_per_pixel);;
     ~Renderer();
@@ -81,8 +114,6 @@ public:
     Vec2 stratified_halton(int pixel_x, int pixel_y, int sample_index, int samples_per_pixel);
     static void create_coordinate_system(const Vec3SIMD& N, Vec3SIMD& T, Vec3SIMD& B);
     void initialize_halton_cache();
-    static std::vector<Vec3SIMD> normalMapBuffer;
-    static std::mutex normalMapBufferMutex;
      
     //std::pair<HittableList, std::shared_ptr<BVHNode>> create_scene(std::vector<std::shared_ptr<Light>>& lights, Vec3& background_color);
      std::pair<HittableList, std::shared_ptr<ParallelBVHNode>> create_scene(std::vector<std::shared_ptr<Light>>& lights, Vec3SIMD& background_color);
@@ -95,12 +126,18 @@ public:
 
     void draw_progress_bar(SDL_Surface* surface, float progress);
 
-    void render_image(SDL_Surface* surface, SDL_Window* window, const int total_samples_per_pixel, const int samples_per_pass);
+    // window may be nullptr (headless): no display thread, no window updates.
+    bool render_image(SDL_Surface* surface, SDL_Window* window, const int total_samples_per_pixel, const int samples_per_pass);
+    void set_scene(const SceneDescription& description) { scene = description; }
+    void set_settings(const RenderSettings& render_settings) { settings = render_settings; }
+    const RenderStats& get_stats() const { return stats; }
+    // AO AOV'sini gri PNG olarak yazar; AO kapalysa false
+    bool save_ao_image(const std::string& path) const;
     void set_camera_position(const Vec3SIMD& position) {
         camera_position = position;
     }
     void initializeBuffers(int image_width, int image_height);
-    static Vec3SIMD apply_normal_map(const HitRecord& rec);
+    static Vec3SIMD apply_normal_map(const HitRecord& rec, const CompiledMaterial& material);
 private:
   
     Camera camera;
@@ -127,6 +164,29 @@ private:
     Vec3SIMD camera_position;
     AtmosphericEffects atmosphericEffects;
     SDL_Renderer* sdlRenderer; // SDL_Renderer pointer' ekleyin
+    SceneDescription scene = SceneLoader::default_scene();
+    RenderSettings settings;
+    RenderStats stats;
+    Denoiser denoiser;
+    std::unique_ptr<LightSampler> light_sampler;   // create_scene'de klardan kurulur
+    LightTable light_table;                        // ayn indekslerle dz k verisi
+    SunVisibilityCache sun_cache;                  // ynl n glge sorgular
+    RadianceCache radiance_cache;                  // nizlemede dolayl yaynk k
+    void build_light_sampling(const std::vector<std::shared_ptr<Light>>& lights, float scene_radius);
+    std::vector<float> accumulation_buffer;   // lineer RGB toplam, yzey satr srasyla
+    std::vector<float> albedo_buffer;         // ilk kesiim albedo toplam
+    std::vector<float> normal_buffer;         // ilk kesiim normal toplam
+    std::vector<float> ao_buffer;             // ilk kesiim AO toplam, AO kapalysa bo
+    std::vector<float> luminance_sq_buffer;   // rnek bana lminans karesi toplam (piksel bana bir)
+    std::vector<float> denoise_input;
+    std::vector<float> denoise_albedo;
+    std::vector<float> denoise_normal;
+    bool denoise_to_surface(SDL_Surface* surface, int total_samples, float blend);
+    // Relative RMS error of the pixel means (needs at least 2 samples).
+    float estimate_noise(int total_samples) const;
+    // Sample count of the next pass in time-budget / noise-target mode; 0 stops.
+    int plan_next_pass(int samples_done, int last_pass_samples, double pass_seconds,
+        double elapsed, double denoise_reserve, float noise) const;
     std::shared_ptr<Texture> background_texture;
     Vec3SIMD sample_directional_light(const ParallelBVHNode* bvh, const DirectionalLight* light, const HitRecord& rec, const Vec3SIMD& light_contribution);
     Vec3SIMD sample_point_light(const ParallelBVHNode* bvh, const PointLight* light, const HitRecord& rec, const Vec3SIMD& light_contribution);
@@ -135,13 +195,34 @@ private:
     void render_worker(int image_height, SDL_Surface* surface, const HittableList& world, const std::vector<std::shared_ptr<Light>>& lights, const Vec3& background_color, const ParallelBVHNode* bvh, const int samples_per_pass, const int current_sample);
     
     void update_display(SDL_Window* window, SDL_Surface* surface);
+    // Piksel toplamlarn birikim/AOV tamponlarna ekler ve yzeye yazar (j: kamera satr)
+    void accumulate_pixel(SDL_Surface* surface, int i, int j, const PixelSums& sums, int samples_per_pass, int current_sample);
+
+    // ray_color ve WavefrontIntegrator'n ortak yol sonlandrma kurallar:
+    // settings.max_depth gvenlik snr, yollar throughput'a bal Rus ruleti bitirir
+    int path_max_depth() const;
+    // Her sekmenin banda, i paracnn RNG'siyle; yol srerse throughput olasla blnr
+    bool continue_path(int bounce, Vec3SIMD& throughput) const;
    
   
  
-    Vec3SIMD ray_color(const Ray& r, const ParallelBVHNode* bvh, const std::vector<std::shared_ptr<Light>>& lights, const Vec3SIMD& background_color, int depth=0, int sample_index=0);
+    Vec3SIMD ray_color(const Ray& r, const ParallelBVHNode* bvh, const std::vector<std::shared_ptr<Light>>& lights, const Vec3SIMD& background_color, PathAOV* aov=nullptr);
     Vec3SIMD calculate_volumetric_lighting(const ParallelBVHNode* bvh, const std::vector<std::shared_ptr<Light>>& lights, const HitRecord& rec, const Ray& ray);
-    Vec3SIMD calculate_light_contribution(const std::shared_ptr<Light>& light, const Vec3SIMD& point, const Vec3SIMD& geometric_normal, const Vec3SIMD& shading_normal, const Vec3SIMD& view_direction, float shininess, float metallic, bool is_global=true);
-    Vec3SIMD calculate_direct_lighting(const ParallelBVHNode* bvh, const std::vector<std::shared_ptr<Light>>& lights, const HitRecord& rec, const Vec3SIMD& normal);
+    Vec3SIMD calculate_light_contribution(int light_index, const Vec3SIMD& point, const Vec3SIMD& to_light, float distance);
+    // BSDF n t uzaklkta bir alan/gen na arptnda power heuristic arl
+    float emission_mis_weight(int light_index, const Ray& ray, float t, const Vec3SIMD& from, float bsdf_pdf) const;
+    // Tek k rnei; alan klarnda BSDF rneklemesiyle MIS arlkl. wo izleyiciye doru.
+    Vec3SIMD calculate_direct_lighting(const ParallelBVHNode* bvh, const std::vector<std::shared_ptr<Light>>& lights, const HitRecord& rec, const Vec3SIMD& wo);
+    // settings.ao_radius iinde engellenmeyen kosins arlkl nlarn oran
+    float ambient_occlusion(const ParallelBVHNode* bvh, const Vec3SIMD& point, const Vec3SIMD& normal);
+    // Ik rneklerini grnrlk dnda hazrlar (en fazla max_shadow_rays); saysn dndrr
+    static constexpr int max_shadow_rays = 25;
+    int prepare_direct_lighting(const HitRecord& rec, const Vec3SIMD& wo, ShadowRay* out);
+    // Seilen alan/gen na katmanl rnek grubu
+    int prepare_area_light(int light_index, float light_pdf, const HitRecord& rec, const Vec3SIMD& wo, ShadowRay* out);
+    bool shadow_occluded(const ParallelBVHNode* bvh, const ShadowRay& shadow) const;
+    // Bir alan  tahmininin rnek says (kare, en fazla 25); 1 ise tek rnek yolu
+    int area_light_batch(int light_index) const;
   
     Vec3 apply_atmospheric_effects(const Vec3& intensity, float distance, bool is_global);
     Vec3SIMD calculate_specular(const Vec3& intensity, const Vec3SIMD& normal, const Vec3SIMD& to_light, const Vec3SIMD& view_direction, float shininess);
@@ -0,0 +1,114 @@
+#ifndef SCENELOADER_H
+#define SCENELOADER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "Vec3.h"
+#include "Matrix4x4.h"
+#include "Light.h"
+#include "Material.h"
+#include "RenderSettings.h"
+
+// JSON scene description. Everything that used to be hard-coded in
+// Renderer::create_scene lives here; default_scene() reproduces it.
+//
+// {
+//   "models":  [ { "path": "flower.gltf",
+//                  "transform": { "translate": [0,0,0], "rotate": [0,90,0], "scale": [1,1,1] },
+//                  "material":  { "type": "principled", "color": [0.8,0.8,0.8], "roughness": 0.5,
+//                                 "metallic": 0.0, "ior": 1.5, "emission": [0,0,0],
+//                                 "emission_strength": 0.0, "texture": "albedo.png" } } ],
+//   "lights":  [ { "type": "directional", "direction": [5,-2,2], "intensity": [0.7,0.6,0.3], "radius": 40 },
+//                { "type": "point", "position": [0,2,0], "intensity": [1,1,1], "radius": 0.1 },
+//                { "type": "spot", "position": [..], "direction": [..], "intensity": [..], "angle": 30, "radius": 0 },
+//                { "type": "area", "position": [..], "u": [..], "v": [..], "width": 1, "height": 1, "intensity": [..] } ],
+//   "camera":  { "position": [-2.6,1.1,1.8], "look_at": [2.6,0.5,-1.3], "up": [0,1,0],
+//                "fov": 40, "aperture": 0, "focus_distance": 30, "blade_count": 4 },
+//   "background": { "color": [0.4,0.5,0.6], "texture": "sky.hdr" },
+//   "sampler": { "samples_per_pixel": 16, "samples_per_pass": 4, "max_depth": 0,
+//                "roulette_depth": 3, "roulette_threshold": 1.0,
+//                "time_budget": 2.5, "noise_target": 0.02, "max_samples_per_pixel": 65536 },
+//   "render":  { "width": 1280, "height": 720, "threads": 0, "output": "output.png",
+//                "denoise": true, "denoise_budget": 0.25 }
+// }
+//
+// Relative paths are resolved against the directory of the scene file.
+// time_budget / noise_target (0 = off) replace the fixed samples_per_pixel
+// with adaptive passes; see Renderer::plan_next_pass.
+
+struct SceneTransform {
+    Vec3 translate = Vec3(0, 0, 0);
+    Vec3 rotate_degrees = Vec3(0, 0, 0);   // applied X, then Y, then Z
+    Vec3 scale = Vec3(1, 1, 1);
+    bool is_identity = true;
+
+    Matrix4x4 matrix() const;
+};
+
+struct SceneMaterial {
+    bool override_material = false;       // false -> keep the materials of the model file
+    std::string type = "principled";      // principled | metal | dielectric
+    Vec3 color = Vec3(0.8, 0.8, 0.8);
+    float roughness = 0.5f;
+    float metallic = 0.0f;
+    float ior = 1.5f;
+    Vec3 emission = Vec3(0, 0, 0);
+    float emission_strength = 0.0f;
+    std::string texture;
+};
+
+struct SceneModel {
+    std::string path;
+    SceneTransform transform;
+    SceneMaterial material;
+};
+
+struct SceneLight {
+    LightType type = LightType::Directional;
+    Vec3 position = Vec3(0, 0, 0);
+    Vec3 direction = Vec3(0, -1, 0);
+    Vec3 intensity = Vec3(1, 1, 1);
+    Vec3 u = Vec3(1, 0, 0);
+    Vec3 v = Vec3(0, 0, 1);
+    float radius = 0.0f;
+    float angle_degrees = 30.0f;
+    float width = 1.0f;
+    float height = 1.0f;
+};
+
+struct SceneCamera {
+    Vec3 lookfrom = Vec3(-2.6, 1.1, 1.8);
+    Vec3 lookat = Vec3(2.6, 0.5, -1.3);
+    Vec3 vup = Vec3(0, 1, 0);
+    double vfov = 40.0;
+    double aperture = 0.0;
+    double focus_dist = 30.0;
+    int blade_count = 4;
+};
+
+struct SceneDescription {
+    std::string source;                   // file the description came from
+    std::vector<SceneModel> models;
+    std::vector<SceneLight> lights;
+    SceneCamera camera;
+    Vec3 background_color = Vec3(0.4, 0.5, 0.6);
+    std::string background_texture;
+    RenderSettings settings;              // "sampler" + "render" sections
+};
+
+class SceneLoader {
+public:
+    // Built-in scene, optionally with a different model file.
+    static SceneDescription default_scene(const std::string& model_path = "");
+    static bool is_scene_file(const std::string& path);
+
+    // Parses and validates a JSON scene. Prints every problem found and
+    // returns false if the description is unusable.
+    static bool load(const std::string& path, SceneDescription& scene);
+
+    static std::shared_ptr<Material> create_material(const SceneMaterial& desc);
+    static std::shared_ptr<Light> create_light(const SceneLight& desc);
+};
+
+#endif // SCENELOADER_H
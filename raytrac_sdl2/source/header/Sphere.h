@@ -16,7 +16,7 @@ public:
 private:
     Vec3 center;
     double radius;
-    std::shared_ptr<Material> material;
+    uint32_t material_id;
 
     Vec3 min() const;
     Vec3 max() const;
@@ -4,12 +4,14 @@
 #include "Light.h"
 #include "Vec3SIMD.h"
 #include "Vec3.h"
+#include <cmath>
 class SpotLight : public Light {
 public:
     SpotLight(const Vec3SIMD& pos, const Vec3SIMD& dir, const Vec3SIMD& intens, float ang, float rad);
     Vec3SIMD position;
     float angle_degrees = 30.0f;
     float angle_radians = angle_degrees * (M_PI / 180.0f);
+    float cos_cone = std::cos(angle_radians);   // cone half angle, computed once
     float radius;
     Vec3SIMD getDirection(const Vec3SIMD& point) const override;
     Vec3SIMD getIntensity(const Vec3SIMD& point) const override;
@@ -0,0 +1,54 @@
+#ifndef SUN_VISIBILITY_CACHE_H
+#define SUN_VISIBILITY_CACHE_H
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "Hittable.h"
+#include "LightTable.h"
+
+class ParallelBVHNode;
+
+// Shadow queries for the scene's directional light without a full BVH walk.
+//
+// Objects are projected into a grid in light space (w points at the sun).
+// Each footprint is dilated by how far a jittered sun ray can drift
+// sideways before climbing past the object's top, so every object a
+// shadow ray can hit is listed in the cell the ray starts in. A query
+// then either finds nothing above the point (lit, no ray traced), tests the
+// few listed objects, or falls back to the BVH when the cell is crowded.
+// Results match the full trace; --bench sun-cache checks that.
+class SunVisibilityCache {
+public:
+    enum class Resolution { Lit, Tested, Fallback };
+
+    // Caches the first directional light in table. Returns false, leaving
+    // the cache empty, when there is none or an object has no bounds.
+    bool build(const std::vector<std::shared_ptr<Hittable>>& objects, const LightTable& table, int resolution = 256);
+    void clear();
+    bool valid() const { return light_index >= 0; }
+    int light() const { return light_index; }
+    size_t entry_count() const { return entries.size(); }
+
+    // Same answer as bvh->hit(Ray(point, to_light), t_min, inf) for a
+    // direction sampled from the cached light.
+    bool occluded(const Vec3SIMD& point, const Vec3SIMD& to_light, float t_min,
+        const ParallelBVHNode* bvh, Resolution* resolved = nullptr) const;
+
+    // Cells with more objects than this go straight to the BVH.
+    static constexpr uint32_t max_cell_objects = 32;
+
+private:
+    int light_index = -1;
+    Vec3SIMD axis_u, axis_v, axis_w;
+    float tan_max = 0.0f;          // widest sideways drift per unit height
+    int res = 0;
+    float origin_u = 0.0f, origin_v = 0.0f;
+    float inv_cell = 0.0f;
+    std::vector<std::shared_ptr<Hittable>> objects;
+    std::vector<uint32_t> cell_start;   // res * res + 1
+    std::vector<uint32_t> entries;      // object indices, tallest first per cell
+    std::vector<float> entry_top;       // top of each entry along axis_w
+};
+
+#endif // SUN_VISIBILITY_CACHE_H
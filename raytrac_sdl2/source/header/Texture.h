@@ -13,6 +13,8 @@ private:
     int height;
      bool m_is_loaded = false;
      std::vector<float> alphas;    // Alfa kanal verileri iin
+     bool m_is_constant = false;   // Tm pikseller ayn renk (1x1 veya tek renk doku)
+     void detect_constant();
 public:
     Texture(const std::string& filename);
     Vec3 getColor(const Vec2& uv) const {
@@ -23,5 +25,15 @@ public:
     Vec3 get_color(double u, double v) const;
     ~Texture();
     bool is_loaded() const { return m_is_loaded; }
+    // Ham piksel eriimi (rneklemek iin dalm kuranlar iin). y = 0 st satr.
+    int get_width() const { return pixels.empty() ? 0 : width; }
+    int get_height() const { return pixels.empty() ? 0 : height; }
+    Vec3 texel(int x, int y) const { return pixels[y * width + x]; }
+    // Tek renkli dokularda get_color her uv iin bu rengi dndrr; malzemeler finalize()'da sabite indirger
+    bool is_constant() const { return m_is_constant; }
+    Vec3 constant_color() const { return pixels.empty() ? Vec3(0, 0, 0) : pixels[0]; }
+    // Alfa kanal yklendi mi; yoksa texel_alpha her yerde 1'dir
+    bool has_alpha() const { return !alphas.empty(); }
+    float texel_alpha(int x, int y) const { return alphas.empty() ? 1.0f : alphas[y * width + x]; }
     
 };
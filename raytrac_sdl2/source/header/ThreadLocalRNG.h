@@ -12,6 +12,9 @@ private:
 public:
     ThreadLocalRNG();
     float get();
+    // One generator per thread, seeded once; constructing a ThreadLocalRNG per
+    // call restarts the same sequence every time.
+    static ThreadLocalRNG& instance();
 };
 
 #endif // THREAD_LOCAL_RNG_H
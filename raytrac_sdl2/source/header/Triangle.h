@@ -23,7 +23,7 @@ public:
     Vec3SIMD n0, n1, n2;  // Normals
     Vec2 t0, t1, t2;  // Texture coordinates
    
-    std::shared_ptr<Material> material;
+    uint32_t material_id = MaterialTable::none;
     Matrix4x4 transform;
     Vec3SIMD albedo0, albedo1, albedo2;
     float metallic0, metallic1, metallic2;
@@ -42,6 +42,7 @@ public:
     std::shared_ptr<Texture> texture;
     std::string materialName;
     int smoothGroup;
+    int light_index = -1;   // TriangleLight::collect yazar; yayan deilse -1
     // Dntrlm haller
     Vec3SIMD transformed_v0, transformed_v1, transformed_v2;
     Vec3SIMD transformed_n0, transformed_n1, transformed_n2;
@@ -60,7 +61,8 @@ public:
     void setUVCoordinates(const Vec2& uv0, const Vec2& uv1, const Vec2& uv2);
         
     // Set material
-    void setMaterial(std::shared_ptr<Material> m) { material = m; }
+    void setMaterial(const std::shared_ptr<Material>& m) { material_id = scene_materials.add(m); }
+    Material* getMaterial() const { return scene_materials.get(material_id); }
     // Set transformation matrix
     void set_transform(const Matrix4x4& t);
     static void updateTriangleTransform(Triangle& triangle, const Matrix4x4& transform);
@@ -71,11 +73,16 @@ public:
 
     // Override hit function for ray-triangle intersection
     virtual bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
+    // Only the intersection test and the material's alpha mask; no normals or shading
+    virtual bool occluded(const Ray& r, double t_min, double t_max) const override;
 
     // Override bounding box function for bounding volume hierarchy (BVH)
     virtual bool bounding_box(double time0, double time1, AABB& output_box) const override;
    
 private:
+    bool intersect(const Ray& r, double t_min, double t_max, float& t, float& u, float& v) const;
+    // True where the material's alpha mask cuts the surface out at barycentrics (u, v)
+    bool masked_out(float u, float v) const;
     Vec3SIMD calculateBarycentricCoordinates(const Vec3SIMD& point) const;
 
     void applyUVCoordinatesToHitRecord(HitRecord& hitRecord, const std::shared_ptr<Triangle>& triangle);
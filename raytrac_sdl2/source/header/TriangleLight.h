@@ -0,0 +1,42 @@
+#ifndef TRIANGLE_LIGHT_H
+#define TRIANGLE_LIGHT_H
+
+#include <memory>
+#include <vector>
+#include "Light.h"
+#include "Hittable.h"
+
+// An emissive mesh triangle seen as a light. The triangle itself stays in
+// the BVH; this carries what next-event estimation needs: world space
+// corners, the normal and the material's constant radiance.
+// intensity is radiance * area, so power based selection weighs it like an
+// AreaLight of the same size.
+class TriangleLight : public Light {
+public:
+    TriangleLight(const Vec3SIMD& a, const Vec3SIMD& b, const Vec3SIMD& c, const Vec3SIMD& radiance);
+
+    Vec3SIMD getDirection(const Vec3SIMD& point) const override;
+    Vec3SIMD getIntensity(const Vec3SIMD& point) const override;
+    Vec3SIMD random_point() const override;
+    LightType type() const override { return LightType::Triangle; }
+
+    const Vec3SIMD& getVertex(int i) const { return vertices[i]; }
+    const Vec3SIMD& getNormal() const { return normal; }
+    float getArea() const { return area; }
+    const Vec3SIMD& getRadiance() const { return radiance; }
+
+    // Appends a light for every Triangle in objects whose material emits the
+    // same radiance everywhere (CompiledMaterial::uniform_emission) and tags
+    // the triangle with its light index so BSDF hits on it can be MIS
+    // weighted. Textured emitters keep light_index -1. Must run after
+    // MaterialTable::compile(). Returns the number of lights added.
+    static size_t collect(const std::vector<std::shared_ptr<Hittable>>& objects, std::vector<std::shared_ptr<Light>>& lights);
+
+private:
+    Vec3SIMD vertices[3];
+    Vec3SIMD normal;
+    float area = 0.0f;
+    Vec3SIMD radiance;
+};
+
+#endif // TRIANGLE_LIGHT_H
@@ -0,0 +1,60 @@
+#ifndef UV_TRANSFORM_H
+#define UV_TRANSFORM_H
+
+#include <cmath>
+#include "Vec2.h"
+
+enum class WrapMode {
+    Repeat,
+    Mirror,
+    Clamp,
+    Planar,   // Texture transform ignored, mesh UVs used as they are
+    Cubic
+};
+
+// Scale, rotation about the tile centre, translation and tiling baked into
+// one 2x3 affine matrix, followed by the wrap mode. Baked when a material's
+// texture transform is set or the material is finalized, so a lookup costs
+// four multiply-adds and a wrap instead of a sin/cos pair in double.
+struct UVTransform {
+    // u' = a * u + b * v + c,  v' = d * u + e * v + f
+    float a = 1.0f, b = 0.0f, c = 0.0f;
+    float d = 0.0f, e = 1.0f, f = 0.0f;
+    WrapMode wrap = WrapMode::Repeat;
+
+    static UVTransform bake(const Vec2& scale, double rotation_degrees, const Vec2& translation,
+        const Vec2& tiling, WrapMode wrap);
+
+    // Affine part only, before wrapping
+    void transform(float u, float v, float& tu, float& tv) const {
+        tu = std::fma(a, u, std::fma(b, v, c));
+        tv = std::fma(d, u, std::fma(e, v, f));
+    }
+
+    Vec2 apply(double u, double v) const {
+        float tu, tv;
+        transform(static_cast<float>(u), static_cast<float>(v), tu, tv);
+        switch (wrap) {
+        case WrapMode::Repeat:
+            return Vec2(tu - std::floor(tu), tv - std::floor(tv));
+        case WrapMode::Mirror:
+            return Vec2(mirror(tu), mirror(tv));
+        case WrapMode::Clamp:
+            return Vec2(std::fmin(std::fmax(tu, 0.0f), 1.0f), std::fmin(std::fmax(tv, 0.0f), 1.0f));
+        case WrapMode::Planar:
+            return Vec2(u, v);
+        case WrapMode::Cubic:
+            return cubic(tu, tv);
+        }
+        return Vec2(tu, tv);
+    }
+
+private:
+    static float mirror(float x) {
+        float t = x - 2.0f * std::floor(0.5f * x);
+        return t > 1.0f ? 2.0f - t : t;
+    }
+    static Vec2 cubic(float u, float v);
+};
+
+#endif // UV_TRANSFORM_H
@@ -21,6 +21,7 @@ public:
     virtual MaterialType type() const override {
         return MaterialType::Volumetric;
     }
+    virtual bool is_specular() const override { return true; }
 
     virtual float get_scattering_factor() const override {
         return scattering_factor;
@@ -50,6 +51,7 @@ public:
     virtual Vec3 getEmission() const override {
         return Vec3(0, 0, 0);  // Volumetrik malzemeler genellikle emisyon yapmaz
     }
+    virtual Vec3 get_albedo(double u, double v) const override { return albedo; }
     Vec3 sample_henyey_greenstein(const Vec3& wi, double g) const;
     void setG(double g) { this->g = g; }
     double density;
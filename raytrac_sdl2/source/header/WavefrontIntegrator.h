@@ -0,0 +1,81 @@
+#ifndef WAVEFRONT_INTEGRATOR_H
+#define WAVEFRONT_INTEGRATOR_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Renderer.h"
+
+// Breadth-first alternative to Renderer::ray_color, selected with --wavefront.
+// All camera rays of a block of pixels go into SoA queues. Every bounce traces
+// the whole queue, sorts the surface hits by material type and id, shades them
+// bin by bin and queues the continuation and shadow rays, which are traced
+// after the shading pass. Consecutive shading calls share one
+// material's code and textures instead of hopping between Dielectric,
+// Volumetric, Metal and PrincipledBSDF from sample to sample.
+//
+// The estimator is ray_color's term for term (MIS, depth cap, roulette,
+// atmosphere, AOVs) except that the radiance cache is neither read nor fed.
+// Keep one instance per thread; the queues are reused from call to call.
+class WavefrontIntegrator {
+public:
+    struct Stats {
+        size_t paths = 0;
+        size_t extension_rays = 0;      // closest-hit rays traced, one per path and bounce
+        size_t vertices = 0;            // shaded surface hits
+        size_t shadow_rays = 0;
+        size_t material_switches = 0;   // shaded hits whose material differs from the one before, per bounce
+    };
+
+    // Paths in flight per wave; a wave holds max(1, wave_size / samples) pixels
+    static constexpr size_t wave_size = 1 << 14;
+
+    // Rows end_row down to start_row, left to right, in render_chunk's order and
+    // coordinates. emit(i, j, sums) runs once per pixel after its paths finish.
+    void render_rows(Renderer& renderer, const ParallelBVHNode* bvh, const Vec3SIMD& background_color,
+        int start_row, int end_row, int samples_per_pixel,
+        const std::function<void(int, int, const PixelSums&)>& emit);
+
+    // Off: shade hits in queue order, to measure what the sort buys
+    bool sort_by_material = true;
+
+    const Stats& stats() const { return counters; }
+    void reset_stats() { counters = Stats(); }
+
+private:
+    void run_wave(Renderer& renderer, const ParallelBVHNode* bvh, const Vec3SIMD& background_color,
+        int samples_per_pixel, const std::function<void(int, int, const PixelSums&)>& emit);
+    // Roulette, closest hit, area lights and misses; queues the surface hits
+    void extend(Renderer& renderer, const ParallelBVHNode* bvh, const Vec3SIMD& background_color, int bounce);
+    // Shades the queued hits and fills next_active and the shadow queue
+    void shade(Renderer& renderer, const ParallelBVHNode* bvh, int bounce);
+    void trace_shadows(const Renderer& renderer, const ParallelBVHNode* bvh);
+
+    // Pixels of the current wave; path p belongs to pixel p / samples_per_pixel
+    std::vector<int> pixel_x, pixel_y;
+
+    // Path state, indexed by path
+    std::vector<Vec3SIMD> origin, direction;
+    std::vector<Vec3SIMD> throughput, radiance;
+    std::vector<Vec3SIMD> prev_point;           // MIS data of the previous scattering
+    std::vector<float> prev_bsdf_pdf;
+    std::vector<uint8_t> prev_specular;
+    std::vector<float> total_distance;
+    std::vector<HitRecord> hits;
+    std::vector<Vec3SIMD> aov_albedo, aov_normal;
+    std::vector<float> aov_ao;
+
+    // Ray queues of path indices, and surface hits keyed by material
+    std::vector<uint32_t> active, next_active;
+    std::vector<uint64_t> shade_keys;
+
+    // Shadow queue; contribution already carries the path throughput
+    std::vector<Vec3SIMD> shadow_origin, shadow_direction, shadow_contribution;
+    std::vector<float> shadow_t_max;
+    std::vector<uint32_t> shadow_path;
+    std::vector<uint8_t> shadow_sun;
+
+    Stats counters;
+};
+
+#endif // WAVEFRONT_INTEGRATOR_H
@@ -20,5 +20,6 @@ extern const double EPSILON;
 extern const int MAX_DEPTH;
 extern std::atomic<int> next_row;
 extern const double infinity;
+extern const size_t light_tree_min_lights;
 
 #endif // GLOBALS_H